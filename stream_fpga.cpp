@@ -51,6 +51,29 @@
 #include <limits.h>
 #include <float.h>
 #include <unistd.h>
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <random>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define HOST_SIMD_X86
+#include <immintrin.h>
+#endif
 
 #include "CL/cl.hpp"
 
@@ -58,6 +81,132 @@
 #include <CL/cl_ext_intelfpga.h>
 #endif
 
+#define STRINGIFY(x) #x
+#define TO_STRING(x) STRINGIFY(x)
+#include <time.h>
+
+/*-----------------------------------------------------------------------
+ * ELEMENT TYPES:
+ *
+ * The host code is written as templates on the element type T of the
+ * arrays, e.g. runStream<T>(). main() selects the element type of the
+ * kernels from --type, the manifest of the kernel file or the argument
+ * metadata of the kernels before the FPGA is used and executes the host
+ * for this type. Without any of them, the type the host was built with
+ * (STREAM_TYPE) is used.
+ *-----------------------------------------------------------------------*/
+
+/*
+*  Host representation of the OpenCL half type. The values are stored with
+*  16 bits like in the kernels, the arithmetic is done in float.
+*-----------------------------------------------------------------------*/
+class HostHalf {
+public:
+    HostHalf() = default;
+    HostHalf(float value) : bits(fromFloat(value)) {}
+    operator float() const { return toFloat(bits); }
+
+private:
+    cl_half bits;
+
+    // Round to the nearest half value, ties to even
+    static cl_half fromFloat(float value) {
+        cl_uint f;
+        memcpy(&f, &value, sizeof(f));
+        cl_uint sign = (f >> 16) & 0x8000;
+        cl_uint mantissa = f & 0x7fffff;
+        int exponent = (int) ((f >> 23) & 0xff) - 127 + 15;
+        if (((f >> 23) & 0xff) == 0xff) {
+            return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+        }
+        if (exponent >= 31) {
+            return sign | 0x7c00;
+        }
+        if (exponent <= 0) {
+            // subnormal half values
+            if (exponent < -10) {
+                return sign;
+            }
+            mantissa |= 0x800000;
+            cl_uint shift = 14 - exponent;
+            cl_uint half = mantissa >> shift;
+            cl_uint rest = mantissa & ((1u << shift) - 1);
+            cl_uint halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1))) {
+                half++;
+            }
+            return sign | half;
+        }
+        cl_uint half = sign | (exponent << 10) | (mantissa >> 13);
+        cl_uint rest = mantissa & 0x1fff;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+            half++;
+        }
+        return half;
+    }
+
+    static float toFloat(cl_half half) {
+        cl_uint sign = (cl_uint) (half & 0x8000) << 16;
+        cl_uint exponent = (half >> 10) & 0x1f;
+        cl_uint mantissa = half & 0x3ff;
+        cl_uint f;
+        if (exponent == 0x1f) {
+            f = sign | 0x7f800000 | (mantissa << 13);
+        }
+        else if (exponent == 0 && mantissa == 0) {
+            f = sign;
+        }
+        else if (exponent == 0) {
+            // normalize subnormal half values
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            f = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+        }
+        else {
+            f = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+        float value;
+        memcpy(&value, &f, sizeof(value));
+        return value;
+    }
+};
+
+namespace std {
+template<> class numeric_limits<HostHalf> : public numeric_limits<float> {
+public:
+    static HostHalf max() { return 65504.0f; }
+    static HostHalf epsilon() { return 0.0009765625f; }
+};
+}
+
+/*
+*  Names of the element types in the host, e.g. cl_double, and in the
+*  kernels, e.g. double.
+*/
+template<typename T> struct StreamTypeName;
+#define STREAM_TYPE_NAMES(TYPE, KERNEL_TYPE)                                  \
+    template<> struct StreamTypeName<TYPE> {                                  \
+        static const char* host() { return "cl_" KERNEL_TYPE; }               \
+        static const char* kernel() { return KERNEL_TYPE; }                   \
+    };
+STREAM_TYPE_NAMES(HostHalf, "half")
+STREAM_TYPE_NAMES(cl_float, "float")
+STREAM_TYPE_NAMES(cl_double, "double")
+STREAM_TYPE_NAMES(cl_int, "int")
+STREAM_TYPE_NAMES(cl_long, "long")
+#undef STREAM_TYPE_NAMES
+
+// Type the host was built with, which is used if the type of the kernels is unknown
+#ifdef STREAM_TYPE
+static const char* defaultStreamType = TO_STRING(STREAM_TYPE);
+#undef STREAM_TYPE
+#else
+static const char* defaultStreamType = "cl_double";
+#endif
+
 /*-----------------------------------------------------------------------
  * INSTRUCTIONS:
  *
@@ -92,6 +241,9 @@
  *                gcc -O -DSTREAM_ARRAY_SIZE=100000000 stream.c -o stream.100M
  *          will override the default size of 10M with a new size of 100M elements
  *          per array.
+ *      For the FPGA version the compile time value is only the default.
+ *          The arrays are allocated on the heap at runtime and the size can be
+ *          changed with the command line option "-s". See printUsage() below.
  */
 #ifndef STREAM_ARRAY_SIZE
 #   define STREAM_ARRAY_SIZE	10000000
@@ -105,6 +257,7 @@
  *         increase the reported performance.
  *      NTIMES can also be set on the compile line without changing the source
  *         code using, for example, "-DNTIMES=7".
+ *      At runtime it can be overwritten with the command line option "-n".
  */
 #ifdef NTIMES
 #if NTIMES<=1
@@ -121,7 +274,7 @@
  *      Use of non-zero values for OFFSET can be especially helpful if the
  *         STREAM_ARRAY_SIZE is set to a value close to a large power of 2.
  *      OFFSET can also be set on the compile line without changing the source
- *         code using, for example, "-DOFFSET=56".
+ *         code using, for example, "-DOFFSET=56" or at runtime with "-o".
  */
 #ifndef OFFSET
 #   define OFFSET	0
@@ -136,6 +289,12 @@
 *           contain multiple devices. The STREAM benchmark is supports only the
 *           execution on a single device. Similar to the platform it has to be
 *           set to the index of the target device.
+*       Both values can be overwritten at runtime with the command line options
+*       "-p" and "-d".
+*       c) HOST_DATA_ALIGNMENT defines the alignment of the host arrays in bytes.
+*           64 bytes are required by the Intel FPGA runtime to use DMA for the
+*           transfers. It can be changed at runtime with "-a", e.g. to use
+*           page aligned arrays.
 */
 #ifndef PLATFORM_ID
 #define PLATFORM_ID 2
@@ -143,6 +302,9 @@
 #ifndef DEVICE_ID
 #define DEVICE_ID 0
 #endif
+#ifndef HOST_DATA_ALIGNMENT
+#define HOST_DATA_ALIGNMENT 64
+#endif
 
 /*
  *	3) Compile the code with optimization.  Many compilers generate
@@ -202,8 +364,23 @@
 #define STREAM_FPGA_KERNEL "stream_kernels.aocx"
 #endif
 
-#ifndef STREAM_TYPE
-#define STREAM_TYPE cl_double
+/*
+*  Build information that is added to the exported results.
+*  The Makefile sets them to the values used for the kernels.
+*/
+#ifndef QUARTUS_VERSION
+#define QUARTUS_VERSION "unknown"
+#endif
+
+#ifndef BOARD_NAME
+#define BOARD_NAME "unknown"
+#endif
+
+/*
+*  The host CPU kernels and the validation are vectorized for float and double.
+*/
+#ifdef HOST_SIMD_X86
+#define HOST_SIMD
 #endif
 
 #define STREAM_COPY_KERNEL "copy"
@@ -211,46 +388,583 @@
 #define STREAM_ADD_KERNEL "add"
 #define STREAM_TRIAD_KERNEL "triad"
 
-static double	avgtime[6] = {0}, maxtime[6] = {0},
-    mintime[6] = {FLT_MAX,FLT_MAX,FLT_MAX,FLT_MAX, FLT_MAX, FLT_MAX};
+// Suffixes of the reader, compute and writer kernel of an operation in
+// stream_kernels_channels.cl, e.g. copy_read, copy_compute and copy_write
+static const char* groupSuffixes[3] = {"_read", "_compute", "_write"};
+
+// Number of input arrays of copy, scale, add and triad and whether they take a scalar
+static const int groupInputs[4] = {1, 1, 2, 2};
+static const bool groupScalar[4] = {false, true, false, true};
+
+// Kernels with strided and indexed accesses in stream_kernels_access.cl
+#define STREAM_STRIDED_COPY_KERNEL "strided_copy"
+#define STREAM_STRIDED_TRIAD_KERNEL "strided_triad"
+#define STREAM_GATHER_KERNEL "gather"
+#define STREAM_SCATTER_KERNEL "scatter"
+#define STREAM_POINTER_CHASE_KERNEL "pointer_chase"
+
+// Number of dependent loads per launch of the pointer chasing kernel
+#define LATENCY_LOADS (1 << 16)
+
+// Kernels with only reads, only writes or an asymmetric ratio of reads and
+// writes in stream_kernels.cl and stream_kernels_vec.cl
+#define STREAM_FILL_KERNEL "fill"
+#define STREAM_SUM_KERNEL "sum"
+#define STREAM_READ_RATIO_KERNEL "read_ratio"
+#define STREAM_WRITE_RATIO_KERNEL "write_ratio"
+
+// Kernel without any work that is used to measure the launch overhead
+#define STREAM_EMPTY_KERNEL "empty"
+
+// Default smallest array size of the sweep mode in bytes
+#define SWEEP_MIN_BYTES 4096
+
+// Largest array size in elements of the back-to-back launches in the launch mode
+#define LAUNCH_MAX_SIZE 32768
+
+/*
+*  Number of elements that read_ratio reads for every written element and
+*  that write_ratio writes for every read element. It has to match the
+*  value the kernels are compiled with.
+*/
+#ifndef READ_WRITE_RATIO
+#define READ_WRITE_RATIO 4
+#endif
+
+/*
+*  Transfer rate of the DDR memory in MT/s and width of the interface of a
+*  memory bank in bytes, which give the theoretical peak bandwidth of a bank.
+*/
+#ifndef DDR_SPEED
+#define DDR_SPEED 2400
+#endif
+#ifndef DDR_BUS_WIDTH
+#define DDR_BUS_WIDTH 8
+#endif
+
+/*
+*  Kernels are flagged as anomaly if their efficiency is below this
+*  fraction of the efficiency of the most efficient kernel.
+*/
+#ifndef ANOMALY_THRESHOLD
+#define ANOMALY_THRESHOLD 0.75
+#endif
+
+/*
+*  Name of the file in $XDG_RUNTIME_DIR, or of the hidden file in $HOME,
+*  in which the host records the hash of the bitstream that it programmed
+*  last on every device, see --skip-reprogram.
+*/
+#ifndef PROGRAMMED_BITSTREAM_FILE
+#define PROGRAMMED_BITSTREAM_FILE "stream_fpga_programmed"
+#endif
+
+/*
+*  Size of a burst of the memory interface in bytes. Accesses that are
+*  further apart than this size need a separate burst each.
+*/
+#ifndef MEMORY_BURST_SIZE
+#define MEMORY_BURST_SIZE 64
+#endif
+
+/*
+*  Runtime configuration of the benchmark.
+*  The compile time definitions above are only used as default values.
+*  They can be overwritten with the command line options given in printUsage().
+*-----------------------------------------------------------------------*/
+enum StreamMode {
+    MODE_DEFAULT,
+    MODE_SWEEP,
+    MODE_CONCURRENT,
+    MODE_MULTI_DEVICE,
+    MODE_PIPELINE,
+    MODE_TRANSFER,
+    MODE_PCIE_SWEEP,
+    MODE_CPU,
+    MODE_ACCESS,
+    MODE_BANK_EXPLORATION,
+    MODE_PARTITION,
+    MODE_READ_WRITE,
+    MODE_LAUNCH,
+    MODE_CHAINED,
+    MODE_LATENCY,
+    MODE_OFFSET_SWEEP
+};
+
+/*
+*  Strategies to transfer the arrays between host and device that are
+*  compared in the transfer mode. The names are used on the command line.
+*/
+enum TransferStrategy {
+    TRANSFER_READ_WRITE,
+    TRANSFER_PINNED,
+    TRANSFER_USE_HOST_PTR,
+    TRANSFER_MAP,
+    TRANSFER_SVM,
+    NUM_TRANSFER_STRATEGIES
+};
+
+static const char* transferNames[NUM_TRANSFER_STRATEGIES] = {"rw", "pinned", "hostptr", "map", "svm"};
+
+/*
+*  Instruction sets for the kernels of the host CPU backend.
+*/
+enum CpuISA {
+    CPU_ISA_AUTO,
+    CPU_ISA_SCALAR,
+    CPU_ISA_AVX2,
+    CPU_ISA_AVX512,
+    NUM_CPU_ISAS
+};
+
+static const char* cpuISANames[NUM_CPU_ISAS] = {"auto", "scalar", "avx2", "avx512"};
+
+/*
+*  Default placement of the arrays A, B and C on the memory banks, which can
+*  be changed with --banks. Bank 0 means that the buffer is interleaved over
+*  all banks. Hosts built with NO_INTERLEAVING place every array on its own
+*  bank by default, which needs kernels compiled with -no-interleaving=default.
+*/
+#ifdef NO_INTERLEAVING
+#define DEFAULT_BANKS {1, 2, 3}
+#define DEFAULT_BANKS_NAME "1,2,3"
+#else
+#define DEFAULT_BANKS {0, 0, 0}
+#define DEFAULT_BANKS_NAME "interleaved"
+#endif
+
+struct StreamConfig {
+    size_t arraySize;
+    bool autoArraySize;
+    unsigned ntimes;
+    unsigned offset;
+    unsigned platformId;
+    unsigned deviceId;
+    size_t alignment;
+    std::string kernelFile;
+    StreamMode mode;
+    size_t sweepMinSize;
+    double sweepFactor;
+    size_t chunkSize;
+    unsigned chunkBuffers;
+    unsigned transferStrategies;
+    bool cpuBackend;
+    unsigned cpuThreads;
+    CpuISA cpuISA;
+    bool cpuNonTemporal;
+    unsigned warmup;
+    bool adaptive;
+    double ciTarget;
+    double timeBudget;
+    std::string csvFile;
+    std::string jsonFile;
+    std::string resultName;
+    double fmax;
+    std::string baselineFile;
+    double regressionThreshold;
+    unsigned maxStride;
+    unsigned banks[3];
+    unsigned numBanks;
+    bool channelKernels;
+    unsigned partitions;
+    std::string elementType;
+    unsigned vectorWidth;
+    unsigned launches;
+    unsigned indexBits;
+    bool indexTiled;
+    bool skipReprogram;
+    double ddrSpeed;
+};
+
+static StreamConfig config = {
+    STREAM_ARRAY_SIZE, false, NTIMES, OFFSET, PLATFORM_ID, DEVICE_ID,
+    HOST_DATA_ALIGNMENT, STREAM_FPGA_KERNEL, MODE_DEFAULT, 0, 2.0,
+    1 << 20, 3, (1 << NUM_TRANSFER_STRATEGIES) - 1, false, 0, CPU_ISA_AUTO, false,
+    1, false, 1.0, 60.0,
+    "", "", "", 0.0, "", 5.0, 64, DEFAULT_BANKS, 4, false, 1, "", 1,
+    1000, 0, false, false, DDR_SPEED
+};
+
+/*
+*  OpenCL objects and host arrays that are used to execute the STREAM
+*  kernels on a device.
+*  The buffers are created for the maximum array size. The number of
+*  elements that is processed by the kernels is set with setArraySize().
+*-----------------------------------------------------------------------*/
+template<typename T>
+struct StreamDevice {
+    cl::Device device;
+    cl::Context context;
+    cl::Program program;
+    cl::CommandQueue queue;
+    cl::Kernel copykernel, scalekernel, addkernel, triadkernel;
+    //Kernels that execute copy, scale, add and triad. Every group contains
+    //the single kernel or the reader, compute and writer kernel of the
+    //channel variant, which are executed on the queues in groupQueues.
+    std::vector<cl::Kernel> groups[4];
+    std::vector<cl::CommandQueue> groupQueues;
+    cl::Buffer Buffer_A, Buffer_B, Buffer_C;
+    //Element offset at which the arrays start within the buffers
+    size_t offset;
+    //Inputs and Outputs to Kernel, X and Y are inputs, Z is output
+    //The arrays are allocated at runtime and aligned to config.alignment bytes
+    //so that DMA can be used for the transfers to the FPGA board
+    T *A, *B, *C;
+};
+
+/*
+*  Context and program of the kernels on a device. They are created once
+*  in main() before the host for the element type of the kernels is
+*  executed, so every device is programmed only once.
+*-----------------------------------------------------------------------*/
+struct StreamProgram {
+    cl::Device device;
+    cl::Context context;
+    cl::Program program;
+    //Time to create and build the program in seconds, which includes the
+    //reprogramming of the FPGA
+    double programTime;
+    //True if the device already held the bitstream and was not reprogrammed
+    bool preloaded;
+};
+
+/*
+*  Read-only memory mapping of a file, e.g. of the kernel file, so it is
+*  loaded in a single pass without a copy. The file is unmapped when the
+*  object is destroyed.
+*-----------------------------------------------------------------------*/
+struct MappedFile {
+    void* data;
+    size_t size;
+
+    MappedFile() : data(NULL), size(0) {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (data != NULL) {
+            munmap(data, size);
+        }
+    }
+};
+
+/*
+*  Reusable barrier to synchronize the host threads of the multi device mode.
+*-----------------------------------------------------------------------*/
+class ThreadBarrier {
+public:
+    ThreadBarrier(unsigned count) : count(count), waiting(0), generation(0) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        unsigned gen = generation;
+        if (++waiting == count) {
+            generation++;
+            waiting = 0;
+            cv.notify_all();
+        }
+        else {
+            cv.wait(lock, [this, gen] { return gen != generation; });
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    unsigned count, waiting, generation;
+};
+
+/*
+*  Measured times of all iterations in seconds, indexed by [label][iteration].
+*  wall contains the times measured on the host around the enqueue and wait
+*  calls. The other fields contain the breakdown from the profiling
+*  information of the OpenCL events:
+*     queued = SUBMIT - QUEUED, submitted = START - SUBMIT, device = END - START
+*  For the PCIe transfers of the three arrays, the breakdown is taken from
+*  the first START to the last END.
+*-----------------------------------------------------------------------*/
+struct StreamTimings {
+    std::vector<std::vector<double> > wall, queued, submitted, device;
+
+    StreamTimings(unsigned ntimes)
+        : wall(6, std::vector<double>(ntimes)), queued(6, std::vector<double>(ntimes)),
+          submitted(6, std::vector<double>(ntimes)), device(6, std::vector<double>(ntimes)) {}
+
+    // Grow or shrink the samples of all labels to the given number of iterations
+    void resize(unsigned iterations) {
+        for (int j=0; j<6; j++) {
+            wall[j].resize(iterations);
+            queued[j].resize(iterations);
+            submitted[j].resize(iterations);
+            device[j].resize(iterations);
+        }
+    }
+};
+
+/*
+*  Results of the default mode for the export to CSV and JSON files.
+*  columns and values contain the results, metadata describes the build
+*  and the configuration of the benchmark.
+*-----------------------------------------------------------------------*/
+struct ResultRecord {
+    std::string name;
+    std::vector<std::string> columns;
+    std::vector<double> values;
+    std::vector<std::pair<std::string, std::string> > metadata;
+};
+
+/*
+*  Statistics of the times of one label without the warm-up iterations.
+*  The confidence interval is given for the mean time with a confidence
+*  level of 95%.
+*-----------------------------------------------------------------------*/
+struct TimeStatistics {
+    size_t samples;
+    double min, avg, max, stddev, median, p95, p99;
+    double ciLow, ciHigh;
+};
 
 static std::string	label[6] = {"Copy:      ", "Scale:     ",
     "Add:       ", "Triad:     ", "PCI Write: ", "PCI Read:  "};
 
-static double	bytes[6] = {
-    2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
-    2 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
-    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
-    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
-    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE,
-    3 * sizeof(STREAM_TYPE) * STREAM_ARRAY_SIZE
-    };
+static double	bytes[6];
+
+// Time from the start of the host until the first kernel finished in seconds
+static double	firstKernelTime;
+
+// Names of the labels in the exported results
+static const char*	resultNames[6] = {"copy", "scale", "add", "triad", "pciw", "pcir"};
 
-//Inputs and Outputs to Kernel, X and Y are inputs, Z is output
-//The aligned attribute is used to ensure alignment
-//so that DMA could be used if we were working with a real FPGA board
-static STREAM_TYPE A[STREAM_ARRAY_SIZE]  __attribute__ ((aligned (64)));
-static STREAM_TYPE B[STREAM_ARRAY_SIZE]  __attribute__ ((aligned (64)));
-static STREAM_TYPE C[STREAM_ARRAY_SIZE]  __attribute__ ((aligned (64)));
+static std::string	cpuLabel[4] = {"CPU Copy:  ", "CPU Scale: ", "CPU Add:   ", "CPU Triad: "};
+
+//Flags to place a buffer on a specific memory bank of the FPGA board
+static const cl_mem_flags bankFlags[] = {CL_CHANNEL_1_INTELFPGA, CL_CHANNEL_2_INTELFPGA,
+                                          CL_CHANNEL_3_INTELFPGA, CL_CHANNEL_4_INTELFPGA};
 
 extern double mysecond();
-extern void checkSTREAMresults();
+template<typename T> int runStream(const cl::Platform& platform, std::vector<StreamProgram>& programs,
+                                   double start_time, double load_time);
+template<typename T> int checkSTREAMresults(const T* A, const T* B, const T* C,
+                                            size_t array_size, bool quiet);
+extern bool parseArguments(int argc, char * argv[]);
+extern bool parseTransferStrategies(const char * list);
+template<typename T> T* allocateHostArray(size_t elements);
+template<typename T> T* allocateAlignedArray(size_t elements, size_t alignment);
+template<typename T> bool setupDevice(StreamDevice<T>& dev, const StreamProgram& prog);
+template<typename T> void freeDevice(StreamDevice<T>& dev);
+template<typename T> void createBuffers(StreamDevice<T>& dev);
+extern std::vector<cl::Kernel> createKernelGroup(const cl::Program& program, const char* name);
+extern void setGroupBuffers(std::vector<cl::Kernel>& group, int j, const cl::Buffer& in1,
+                            const cl::Buffer& in2, const cl::Buffer& out);
+template<typename T> void setGroupScalar(std::vector<cl::Kernel>& group, int j, T scalar);
+extern void setIndexArg(cl::Kernel& kernel, cl_uint index, size_t value);
+extern void setGroupSize(std::vector<cl::Kernel>& group, int j, size_t array_size);
+extern void setGroupOffset(std::vector<cl::Kernel>& group, int j, size_t offset);
+template<typename T> void enqueueKernelGroup(StreamDevice<T>& dev, std::vector<cl::Kernel>& group,
+                                             const std::vector<cl::Event>* wait_list, std::vector<cl::Event>& events);
+template<typename T> cl_int runKernelGroup(StreamDevice<T>& dev, std::vector<cl::Kernel>& group, std::vector<cl::Event>& events);
+extern cl_mem_flags bankFlag(unsigned bank);
+extern bool interleavedPlacement();
+extern std::string placementName();
+extern bool parseBanks(const char * list);
+extern bool readKeyValueFile(const std::string& file_name, std::map<std::string, std::string>& values);
+extern bool readKernelManifest(const std::string& kernel_file, std::map<std::string, std::string>& values);
+extern bool mapFile(const std::string& file_name, MappedFile& file);
+extern std::string hashFile(const MappedFile& file);
+extern std::string programmedBitstreamFile();
+extern std::string programmedDeviceKey(const cl::Device& device);
+extern std::string programmedBitstream(const cl::Device& device);
+extern void recordProgrammedBitstream(const cl::Device& device, const std::string& hash);
+extern cl::Context createContext(const std::vector<cl::Device>& devices, bool& preloaded);
+extern bool preloadedKernelsMatch(const cl::Program& program);
+extern void createProgram(StreamProgram& prog, const cl::Device& device, const cl::Program::Binaries& binaries,
+                          const std::string& hash);
+extern bool selectElementType();
+extern bool selectIndexBits();
+extern size_t maxKernelIndex();
+extern bool readReportFmax(const std::string& kernel_file, double& fmax);
+extern void printRoofline(const StreamTimings& times);
+extern std::string indexName();
+extern bool kernelArgTypes(const cl::Program& program, std::string& type, unsigned& width);
+extern unsigned kernelIndexBits(const cl::Program& program);
+extern bool checkKernelTypes(const cl::Program& program);
+template<typename T> void setArraySize(StreamDevice<T>& dev, size_t array_size);
+template<typename T> void executeIterations(StreamDevice<T>& dev, size_t array_size,
+                                            StreamTimings& times, bool verbose, ThreadBarrier* barrier);
+template<typename T> void executeIteration(StreamDevice<T>& dev, size_t array_size, StreamTimings& times, unsigned k);
+template<typename T> unsigned executeAdaptive(StreamDevice<T>& dev, StreamTimings& times);
+template<typename T> unsigned maxValidIterations();
+extern void recordProfiling(StreamTimings& times, int j, unsigned k,
+                            const std::vector<cl::Event>& events);
+extern bool eventsOverlap(const std::vector<cl::Event>& events);
+extern double minTime(const std::vector<double>& times);
+extern double avgTime(const std::vector<double>& times);
+extern double maxTime(const std::vector<double>& times);
+extern TimeStatistics timeStatistics(const std::vector<double>& times);
+extern void printStatistics(const std::string& label, const std::vector<double>& times, double label_bytes);
+template<typename T> void printArrayInfo();
+extern unsigned hostThreads();
+template<typename T> size_t partitionSize(size_t array_size, unsigned num_threads);
+template<typename T> void parallelFor(size_t array_size, const std::function<void(unsigned, size_t, size_t)>& body);
+template<typename T> void fillArrays(T* A, T* B, T* C, size_t begin, size_t end,
+                                     T a, T b, T c);
+template<typename T> void initializeArrays(T* A, T* B, T* C, size_t array_size);
+template<typename T> void runSweep(StreamDevice<T>& dev);
+template<typename T> void runConcurrent(StreamDevice<T>& dev);
+template<typename T> void runPipeline(StreamDevice<T>& dev);
+template<typename T> bool measureTransfers(StreamDevice<T>& dev, TransferStrategy strategy,
+                                           std::vector<double>& write_times, std::vector<double>& read_times,
+                                           size_t& errors);
+template<typename T> void runTransfers(StreamDevice<T>& dev);
+template<typename T> void runPCIeSweep(StreamDevice<T>& dev);
+template<typename T> void runAccessSweep(StreamDevice<T>& dev);
+template<typename T> void runReadWrite(StreamDevice<T>& dev);
+extern void printLatencyRow(const char* label, const std::vector<double>& times);
+template<typename T> void runLaunchLatency(StreamDevice<T>& dev);
+template<typename T> void runChained(StreamDevice<T>& dev);
+template<typename T> void runMemoryLatency(StreamDevice<T>& dev);
+template<typename T> size_t maxSweepOffset();
+template<typename T> void runOffsetSweep(StreamDevice<T>& dev);
+template<typename T> void runBankExploration(StreamDevice<T>& dev);
+template<typename T> std::vector<StreamDevice<T> > createPartitions(StreamDevice<T>& dev, unsigned n, std::vector<size_t>& lengths);
+template<typename T> bool executePartitioned(std::vector<StreamDevice<T> >& parts, const std::vector<size_t>& lengths,
+                                             StreamTimings& times, unsigned k);
+template<typename T> void runPartitionScaling(StreamDevice<T>& dev);
+template<typename T> bool runMultiDevice(std::vector<StreamProgram>& programs);
+template<typename T> int runCpuBackend(std::vector<std::vector<double> >& times);
+template<typename T> void printCpuResults(const std::vector<std::vector<double> >& times);
+template<typename T> int runCpuOnly();
+template<typename T> ResultRecord createResultRecord(const StreamDevice<T>& dev, const StreamTimings& times);
+extern bool writeCSV(const ResultRecord& record, const std::string& file_name);
+extern bool writeJSON(const ResultRecord& record, const std::string& file_name);
+extern int compareBaseline(const ResultRecord& record, const std::string& file_name);
 
 int main(int argc, char * argv[])
+{
+    double		start_time = mysecond();
+    double		load_time = 0.0;
+    int			err;
+
+    if (!parseArguments(argc, argv) || !selectElementType() || !selectIndexBits()) {
+        return 1;
+    }
+    if (config.fmax == 0.0 && readReportFmax(config.kernelFile, config.fmax)) {
+        std::cout << "Read kernel fMax " << config.fmax << " MHz from the report of the kernels" << std::endl;
+    }
+
+    cl::Platform platform;
+    std::vector<StreamProgram> programs;
+    MappedFile aocx;
+    if (config.mode != MODE_CPU) {
+// Setting up OpenCL for FPGA
+        //Setup Platform
+        //Get Platform ID
+        std::vector<cl::Platform> PlatformList;
+        err = cl::Platform::get(&PlatformList);
+        assert(err==CL_SUCCESS);
+
+        if (config.platformId >= PlatformList.size()) {
+            std::cerr << "Platform " << config.platformId << " not available! Found "
+                      << PlatformList.size() << " platform(s)." << std::endl;
+            return 1;
+        }
+        platform = PlatformList[config.platformId];
+
+        //Setup Device
+        //Get Device ID
+        std::vector<cl::Device> DeviceList;
+        err = platform.getDevices(CL_DEVICE_TYPE_ACCELERATOR, &DeviceList);
+        assert(err==CL_SUCCESS);
+
+        if (config.deviceId >= DeviceList.size()) {
+            std::cerr << "Device " << config.deviceId << " not available! Found "
+                      << DeviceList.size() << " device(s)." << std::endl;
+            return 1;
+        }
+        // The used device comes first, the multi device mode uses all devices
+        std::vector<cl::Device> devices(1, DeviceList[config.deviceId]);
+        if (config.mode == MODE_MULTI_DEVICE) {
+            devices = DeviceList;
+            std::swap(devices[0], devices[config.deviceId]);
+        }
+
+        //Read in binaries from file
+        load_time = mysecond();
+        if (!mapFile(config.kernelFile, aocx)) {
+            std::cerr << "Not possible to open from given file!" << std::endl;
+            return 1;
+        }
+        std::string aocx_hash = hashFile(aocx);
+        load_time = mysecond() - load_time;
+
+        cl::Program::Binaries mybinaries;
+        mybinaries.push_back({aocx.data, aocx.size});
+
+        //Program every device once, the host for the element type uses the programs
+        programs.resize(devices.size());
+        for (size_t d=0; d<devices.size(); d++) {
+            createProgram(programs[d], devices[d], mybinaries, aocx_hash);
+        }
+        if (!checkKernelTypes(programs[0].program)) {
+            return 1;
+        }
+    }
+
+    // Execute the host for the element type of the kernels
+    std::string type = config.elementType.empty() ? std::string(defaultStreamType).substr(3) : config.elementType;
+    if (type == "half") {
+        return runStream<HostHalf>(platform, programs, start_time, load_time);
+    }
+    if (type == "float") {
+        return runStream<cl_float>(platform, programs, start_time, load_time);
+    }
+    if (type == "double") {
+        return runStream<cl_double>(platform, programs, start_time, load_time);
+    }
+    if (type == "int") {
+        return runStream<cl_int>(platform, programs, start_time, load_time);
+    }
+    if (type == "long") {
+        return runStream<cl_long>(platform, programs, start_time, load_time);
+    }
+    std::cerr << "Element type " << type << " is not supported!" << std::endl;
+    return 1;
+}
+
+/*
+*  Execute the benchmark for the element type T. programs contains the
+*  programs of the kernels on the used device followed by the other devices
+*  of the multi device mode. It is empty for the host CPU backend.
+*-----------------------------------------------------------------------*/
+template<typename T>
+int runStream(const cl::Platform& platform, std::vector<StreamProgram>& programs,
+              double start_time, double load_time)
 {
     int			quantum, checktick();
     int			BytesPerWord;
-    int			k;
     ssize_t		j;
-    STREAM_TYPE		test_scalar, scalar;
-    double		t, times[6][NTIMES];
+    T		test_scalar;
+    double		t;
+
+    if (config.sweepMinSize == 0) {
+        config.sweepMinSize = SWEEP_MIN_BYTES / sizeof(T);
+    }
+    // The values of the arrays must not overflow T during the iterations
+    if (config.ntimes > maxValidIterations<T>()) {
+        config.ntimes = maxValidIterations<T>();
+        std::cout << "Number of iterations reduced to " << config.ntimes
+                  << ", more iterations would overflow " << StreamTypeName<T>::host() << std::endl;
+        if (config.ntimes < 2 || config.warmup >= config.ntimes) {
+            std::cerr << "Not enough iterations for " << StreamTypeName<T>::host() << "!" << std::endl;
+            return 1;
+        }
+    }
 
     /* --- SETUP --- determine precision and check timing --- */
 
     printf(HLINE);
     printf("STREAM FPGA based in STREAM version $Revision: 5.10 $\n");
     printf(HLINE);
-    BytesPerWord = sizeof(STREAM_TYPE);
+    BytesPerWord = sizeof(T);
     printf("This system uses %d bytes per array element.\n",
     BytesPerWord);
 
@@ -263,155 +977,126 @@ int main(int argc, char * argv[])
     printf("*****  WARNING: ******\n");
 #endif
 
-    printf("Array size = %llu (elements), Offset = %d (elements)\n" , (unsigned long long) STREAM_ARRAY_SIZE, OFFSET);
-    printf("Memory per array = %.1f MiB (= %.1f GiB).\n",
-    BytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0),
-    BytesPerWord * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.0/1024.0));
-    printf("Total memory required = %.1f MiB (= %.1f GiB).\n",
-    (3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024.),
-    (3.0 * BytesPerWord) * ( (double) STREAM_ARRAY_SIZE / 1024.0/1024./1024.));
-    printf("Each kernel will be executed %d times.\n", NTIMES);
-    printf(" The *best* time for each kernel (excluding the first iteration)\n");
-    printf(" will be used to compute the reported bandwidth.\n");
-    printf(HLINE);
-
-    //Allocates memory with value from 0 to 1000
-    for (int j=0; j<STREAM_ARRAY_SIZE; j++) {
-        A[j] = 1.0;
-        B[j] = 2.0;
-        C[j] = 0.0;
+    if (config.mode == MODE_CPU) {
+        printArrayInfo<T>();
+        return runCpuOnly<T>();
     }
 
-    int err;
-// Setting up OpenCL for FPGA
-    //Setup Platform
-    //Get Platform ID
-    std::vector<cl::Platform> PlatformList;
-    err = cl::Platform::get(&PlatformList);
-    assert(err==CL_SUCCESS);
-
-    cl::Platform platform = PlatformList[PLATFORM_ID];
+    StreamDevice<T> dev;
+    cl::Device& device = programs[0].device;
     std::cout << "Platform Name: " << platform.getInfo<CL_PLATFORM_NAME>() << std::endl;
+    std::cout << "Device Name:   " << device.getInfo<CL_DEVICE_NAME>() << std::endl;
+    if (config.mode != MODE_BANK_EXPLORATION) {
+        std::cout << "Banks A,B,C:   " << placementName() << std::endl;
+    }
+    if (config.channelKernels) {
+        std::cout << "Kernels:       reader, compute and writer connected by channels" << std::endl;
+    }
+    std::cout << "Element type:  " << StreamTypeName<T>::kernel() << ", vector width " << config.vectorWidth << std::endl;
+    std::cout << "Array index:   " << indexName() << std::endl;
+    if (config.fmax > 0.0) {
+        std::cout << "Kernel fMax:   " << config.fmax << " MHz" << std::endl;
+    }
 
-    //Setup Device
-    //Get Device ID
-    std::vector<cl::Device> DeviceList;
-    err = PlatformList[PLATFORM_ID].getDevices(CL_DEVICE_TYPE_ACCELERATOR, &DeviceList);
-    assert(err==CL_SUCCESS);
-
-    //Create Context
-    cl::Context streamcontext(DeviceList);
-    assert(err==CL_SUCCESS);
-    std::cout << "Device Name:   " << DeviceList[DEVICE_ID].getInfo<CL_DEVICE_NAME>() << std::endl;
-    //Create Command queue
-    cl::CommandQueue streamqueue(streamcontext, DeviceList[DEVICE_ID]);
-    assert(err==CL_SUCCESS);
-
-#ifdef NO_INTERLEAVING
-    //Create Buffers for input and output
-    cl::Buffer Buffer_A(streamcontext, CL_MEM_READ_WRITE | CL_CHANNEL_1_INTELFPGA, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE);
-    cl::Buffer Buffer_B(streamcontext, CL_MEM_READ_WRITE | CL_CHANNEL_2_INTELFPGA, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE);
-    cl::Buffer Buffer_C(streamcontext, CL_MEM_READ_WRITE | CL_CHANNEL_3_INTELFPGA, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE);
-#else
-    //Create Buffers for input and output
-    cl::Buffer Buffer_A(streamcontext, CL_MEM_READ_WRITE, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE);
-    cl::Buffer Buffer_B(streamcontext, CL_MEM_READ_WRITE, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE);
-    cl::Buffer Buffer_C(streamcontext, CL_MEM_READ_WRITE, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE);
-#endif
-
-    //Read in binaries from file
-    char* used_kernel = (char*) STREAM_FPGA_KERNEL;
-    if (argc > 1) {
-        std::cout << "Using kernel given as argument" << std::endl;
-        used_kernel = argv[1];
+    //Size the arrays to the memory of the used device if requested
+    cl_ulong global_mem_size = device.getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
+    cl_ulong max_alloc_size = device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+    // The offset sweep creates the buffers for its largest offset
+    size_t max_offset = (config.mode == MODE_OFFSET_SWEEP) ? MAX(config.offset, maxSweepOffset<T>()) : config.offset;
+    if (config.autoArraySize) {
+        // The concurrent mode uses a separate set of buffers for every kernel
+        size_t num_arrays = (config.mode == MODE_CONCURRENT) ? 12 : 3;
+        config.arraySize = MIN(global_mem_size / num_arrays, max_alloc_size) / sizeof(T);
+        config.arraySize = MIN(config.arraySize, maxKernelIndex()) - max_offset;
+        // Keep the size a multiple of the vector width used in the kernels
+        config.arraySize -= config.arraySize % 64;
     }
-    std::cout << "Kernel:        " << used_kernel << std::endl;
-    std::cout << HLINE;
-    std::ifstream aocx_stream(used_kernel, std::ifstream::binary);
-    if (!aocx_stream.is_open()){
-        std::cerr << "Not possible to open from given file!" << std::endl;
+    if (config.offset % config.vectorWidth != 0) {
+        std::cerr << "The offset has to be a multiple of the vector width!" << std::endl;
+        return 1;
+    }
+    if (config.mode == MODE_OFFSET_SWEEP && config.vectorWidth > 1) {
+        std::cerr << "The offset sweep needs kernels without vectors, the kernels with vector width "
+                  << config.vectorWidth << " only support aligned offsets!" << std::endl;
+        return 1;
+    }
+    // copy and scale of stream_kernels_vec.cl process two vectors per iteration
+    if (config.arraySize % (2 * config.vectorWidth) != 0) {
+        config.arraySize -= config.arraySize % (2 * config.vectorWidth);
+        std::cout << "Array size reduced to a multiple of twice the vector width" << std::endl;
+    }
+    config.sweepMinSize = MAX(config.sweepMinSize - config.sweepMinSize % (2 * config.vectorWidth),
+                              (size_t) (2 * config.vectorWidth));
+    if (config.chunkSize % (2 * config.vectorWidth) != 0) {
+        config.chunkSize += 2 * config.vectorWidth - config.chunkSize % (2 * config.vectorWidth);
+        if (config.mode == MODE_PIPELINE) {
+            std::cout << "Chunk size increased to a multiple of twice the vector width" << std::endl;
+        }
+    }
+    if (sizeof(T) * (config.arraySize + max_offset) > max_alloc_size) {
+        std::cerr << "Array size exceeds the maximum buffer size of the device ("
+                  << max_alloc_size << " bytes)!" << std::endl;
+        return 1;
+    }
+    if (config.arraySize + max_offset > maxKernelIndex()) {
+        std::cerr << "Array size and offset exceed the 32 bit arguments of the kernels!" << std::endl;
         return 1;
     }
+    std::cout << HLINE;
 
-    std::string prog(std::istreambuf_iterator<char>(aocx_stream), (std::istreambuf_iterator<char>()));
-    aocx_stream.seekg(0, aocx_stream.end);
-    unsigned file_size = aocx_stream.tellg();
-    aocx_stream.seekg(0,aocx_stream.beg);
-    char * buf = new char[file_size];
-    aocx_stream.read(buf, file_size);
+    printArrayInfo<T>();
 
-    cl::Program::Binaries mybinaries;
-    mybinaries.push_back({buf, file_size});
-    std::vector<cl::Device> usedDevice;
-    usedDevice.push_back(DeviceList[DEVICE_ID]);
+    for (int k=0; k<6; k++) {
+        bytes[k] = ((k == 0 || k == 1) ? 2 : 3) * sizeof(T) * (double) config.arraySize;
+    }
+    StreamTimings times(config.ntimes);
 
-    // Create the Program from the AOCX file.
-    cl::Program program(streamcontext, usedDevice, mybinaries);
-    program.build();
+    std::cout << "Kernel:        " << config.kernelFile << std::endl;
+    std::cout << HLINE;
 
-    // create the kernels
-    cl::Kernel testkernel(program, STREAM_SCALE_KERNEL, &err);
-    assert(err==CL_SUCCESS);
-    cl::Kernel copykernel(program, STREAM_COPY_KERNEL, &err);
-    assert(err==CL_SUCCESS);
-    cl::Kernel scalekernel(program, STREAM_SCALE_KERNEL, &err);
-    assert(err==CL_SUCCESS);
-    cl::Kernel addkernel(program, STREAM_ADD_KERNEL, &err);
-    assert(err==CL_SUCCESS);
-    cl::Kernel triadkernel(program, STREAM_TRIAD_KERNEL, &err);
-    assert(err==CL_SUCCESS);
+    if (config.mode == MODE_MULTI_DEVICE) {
+        return runMultiDevice<T>(programs) ? 0 : 1;
+    }
+
+    if (!setupDevice(dev, programs[0])) {
+        return 1;
+    }
+    size_t buffer_size = sizeof(T) * config.arraySize;
+
+    // create the kernels for the timing check, which scale A in place
+    std::vector<cl::Kernel> testkernels = createKernelGroup(dev.program, STREAM_SCALE_KERNEL);
 
-    scalar = 3.0;
     test_scalar = 2.0E0;
     //prepare kernels
-    err = testkernel.setArg(0, Buffer_A);
-    assert(err==CL_SUCCESS);
-    err = testkernel.setArg(1, Buffer_A);
-    assert(err==CL_SUCCESS);
-    err = testkernel.setArg(2, test_scalar);
-    assert(err==CL_SUCCESS);
-    err = testkernel.setArg(3, STREAM_ARRAY_SIZE);
-    assert(err==CL_SUCCESS);
-    //set arguments of copy kernel
-    err = copykernel.setArg(0, Buffer_A);
-    assert(err==CL_SUCCESS);
-    err = copykernel.setArg(1, Buffer_C);
-    assert(err==CL_SUCCESS);
-    err = copykernel.setArg(2, STREAM_ARRAY_SIZE);
-    assert(err==CL_SUCCESS);
-    //set arguments of scale kernel
-    err = scalekernel.setArg(0, Buffer_C);
-    assert(err==CL_SUCCESS);
-    err = scalekernel.setArg(1, Buffer_B);
-    assert(err==CL_SUCCESS);
-    err = scalekernel.setArg(2, scalar);
-    assert(err==CL_SUCCESS);
-    err = scalekernel.setArg(3, STREAM_ARRAY_SIZE);
-    assert(err==CL_SUCCESS);
-    //set arguments of add kernel
-    err = addkernel.setArg(0, Buffer_A);
-    assert(err==CL_SUCCESS);
-    err = addkernel.setArg(1, Buffer_B);
-    assert(err==CL_SUCCESS);
-    err = addkernel.setArg(2, Buffer_C);
-    assert(err==CL_SUCCESS);
-    err = addkernel.setArg(3, STREAM_ARRAY_SIZE);
-    assert(err==CL_SUCCESS);
-    //set arguments of triad kernel
-    err = triadkernel.setArg(0, Buffer_B);
-    assert(err==CL_SUCCESS);
-    err = triadkernel.setArg(1, Buffer_C);
-    assert(err==CL_SUCCESS);
-    err = triadkernel.setArg(2, Buffer_A);
-    assert(err==CL_SUCCESS);
-    err = triadkernel.setArg(3, scalar);
-    assert(err==CL_SUCCESS);
-    err = triadkernel.setArg(4, STREAM_ARRAY_SIZE);
-    assert(err==CL_SUCCESS);
+    setGroupBuffers(testkernels, 1, dev.Buffer_A, dev.Buffer_A, dev.Buffer_A);
+    setGroupScalar(testkernels, 1, test_scalar);
+    setGroupSize(testkernels, 1, config.arraySize);
+    setGroupOffset(testkernels, 1, dev.offset);
     std::cout << "Prepared FPGA successfully!" << std::endl;
     std::cout << HLINE;
 //End prepare FPGA
 
+    if (config.mode != MODE_DEFAULT) {
+        switch (config.mode) {
+            case MODE_SWEEP: runSweep(dev); break;
+            case MODE_CONCURRENT: runConcurrent(dev); break;
+            case MODE_PIPELINE: runPipeline(dev); break;
+            case MODE_TRANSFER: runTransfers(dev); break;
+            case MODE_PCIE_SWEEP: runPCIeSweep(dev); break;
+            case MODE_ACCESS: runAccessSweep(dev); break;
+            case MODE_READ_WRITE: runReadWrite(dev); break;
+            case MODE_LAUNCH: runLaunchLatency(dev); break;
+            case MODE_CHAINED: runChained(dev); break;
+            case MODE_LATENCY: runMemoryLatency(dev); break;
+            case MODE_OFFSET_SWEEP: runOffsetSweep(dev); break;
+            case MODE_BANK_EXPLORATION: runBankExploration(dev); break;
+            case MODE_PARTITION: runPartitionScaling(dev); break;
+            default: break;
+        }
+        freeDevice(dev);
+        return 0;
+    }
+
     if  ( (quantum = checktick()) >= 1)
     printf("Your clock granularity/precision appears to be "
         "%d microseconds.\n", quantum);
@@ -421,19 +1106,25 @@ int main(int argc, char * argv[])
     quantum = 1;
     }
 
-    streamqueue.enqueueWriteBuffer(Buffer_A, CL_TRUE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, A);
-    streamqueue.finish();
+    dev.queue.enqueueWriteBuffer(dev.Buffer_A, CL_TRUE, sizeof(T) * dev.offset, buffer_size, dev.A);
+    dev.queue.finish();
 
-    cl::Event e;
+    std::vector<cl::Event> test_events;
     t = mysecond();
-    streamqueue.enqueueTask(testkernel, NULL, &e);
-    err=e.wait();
+    runKernelGroup(dev, testkernels, test_events);
+    firstKernelTime = mysecond() - start_time;
     t = 1.0E6 * (mysecond() - t);
 
-    streamqueue.enqueueReadBuffer(Buffer_A, CL_TRUE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, A);
-    err=streamqueue.finish();
+    dev.queue.enqueueReadBuffer(dev.Buffer_A, CL_TRUE, sizeof(T) * dev.offset, buffer_size, dev.A);
+    dev.queue.finish();
 
 
+    printf("Time to first kernel: %.3f seconds (bitstream loading %.3f s, %s %.3f s)\n",
+           firstKernelTime, load_time,
+           programs[0].preloaded ? "program creation without reprogramming" : "programming",
+           programs[0].programTime);
+    printf(HLINE);
+
     printf("Each test below will take on the order"
     " of %d microseconds.\n", (int) t  );
     printf("   (= %d clock ticks)\n", (int) (t/quantum) );
@@ -447,83 +1138,4044 @@ int main(int argc, char * argv[])
     printf("precision of your system timer.\n");
     printf(HLINE);
 
-    for (int k=0; k < NTIMES; k++) {
-        std::cout << "Execute iteration " << (k + 1) << " of " << NTIMES << std::endl;
-        //Write data to device
-        times[4][k] = mysecond();
-        streamqueue.enqueueWriteBuffer(Buffer_A, CL_FALSE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, A);
-        streamqueue.enqueueWriteBuffer(Buffer_B, CL_FALSE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, B);
-        streamqueue.enqueueWriteBuffer(Buffer_C, CL_FALSE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, C);
-        err = streamqueue.finish();
-        times[4][k] = mysecond() - times[4][k];
-
-        assert(err==CL_SUCCESS);
-
-    times[0][k] = mysecond();
-    streamqueue.enqueueTask(copykernel, NULL, &e);
-    err=e.wait();
-    times[0][k] = mysecond() - times[0][k];
-
-    assert(err==CL_SUCCESS);
-
-    times[1][k] = mysecond();
-    streamqueue.enqueueTask(scalekernel, NULL, &e);
-    err=e.wait();
-    times[1][k] = mysecond() - times[1][k];
-    assert(err==CL_SUCCESS);
-
-    times[2][k] = mysecond();
-    streamqueue.enqueueTask(addkernel, NULL, &e);
-    err=e.wait();
-    times[2][k] = mysecond() - times[2][k];
-    assert(err==CL_SUCCESS);
-
-    times[3][k] = mysecond();
-    streamqueue.enqueueTask(triadkernel, NULL, &e);
-    err=e.wait();
-    times[3][k] = mysecond() - times[3][k];
-    assert(err==CL_SUCCESS);
-
-        // read the output
-        times[5][k] = mysecond();
-        streamqueue.enqueueReadBuffer(Buffer_A, CL_FALSE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, A);
-        streamqueue.enqueueReadBuffer(Buffer_B, CL_FALSE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, B);
-        streamqueue.enqueueReadBuffer(Buffer_C, CL_FALSE, 0, sizeof(STREAM_TYPE)*STREAM_ARRAY_SIZE, C);
-        err=streamqueue.finish();
-        times[5][k] = mysecond() - times[5][k];
-        assert(err==CL_SUCCESS);
+    if (config.adaptive) {
+        // The following results and the validation use the number of
+        // iterations that were actually executed
+        config.ntimes = executeAdaptive(dev, times);
+    }
+    else {
+        executeIterations(dev, config.arraySize, times, true, NULL);
+    }
 
+    // Execute the same kernels on the host CPU for comparison
+    std::vector<std::vector<double> > cpu_times(4, std::vector<double>(config.ntimes));
+    int cpu_errors = 0;
+    if (config.cpuBackend) {
+        cpu_errors = runCpuBackend<T>(cpu_times);
+        if (cpu_errors < 0) {
+            std::cerr << "Not possible to allocate the arrays for the host CPU backend!" << std::endl;
+            freeDevice(dev);
+            return 1;
+        }
+        printf(HLINE);
     }
 
 /*	--- SUMMARY --- */
 
-    for (k=1; k<NTIMES; k++) /* note -- skip first iteration */
-    {
-    for (j=0; j<6; j++)
-        {
-        avgtime[j] = avgtime[j] + times[j][k];
-        mintime[j] = MIN(mintime[j], times[j][k]);
-        maxtime[j] = MAX(maxtime[j], times[j][k]);
+    printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
+    for (j=0; j<6; j++) {
+    printf("%s%12.1f  %11.6f  %11.6f  %11.6f\n", label[j].c_str(),
+           1.0E-06 * bytes[j]/minTime(times.wall[j]),
+           avgTime(times.wall[j]),
+           minTime(times.wall[j]),
+           maxTime(times.wall[j]));
+    }
+    if (config.cpuBackend) {
+        printCpuResults<T>(cpu_times);
+    }
+    printf(HLINE);
+
+    printf("Timing breakdown from OpenCL event profiling (averages in microseconds):\n");
+    printf("Function    Device MB/s  E2E MB/s  Queued->Submit  Submit->Start  Start->End  Overhead\n");
+    for (j=0; j<6; j++) {
+    printf("%s%11.1f  %8.1f  %14.1f  %13.1f  %10.1f  %7.1f%%\n", label[j].c_str(),
+           1.0E-06 * bytes[j]/minTime(times.device[j]),
+           1.0E-06 * bytes[j]/minTime(times.wall[j]),
+           1.0E6 * avgTime(times.queued[j]),
+           1.0E6 * avgTime(times.submitted[j]),
+           1.0E6 * avgTime(times.device[j]),
+           100.0 * (1.0 - avgTime(times.device[j]) / avgTime(times.wall[j])));
+    }
+    printf(HLINE);
+
+    printf("Statistics of the times in seconds and the 95%% confidence interval of the mean rate:\n");
+    printf("Function    Samples  Median       Stddev       p95          p99          Mean rate CI MB/s\n");
+    for (j=0; j<6; j++) {
+        printStatistics(label[j], times.wall[j], bytes[j]);
+    }
+    if (config.cpuBackend) {
+        for (j=0; j<4; j++) {
+            printStatistics(cpuLabel[j], cpu_times[j], bytes[j]);
+        }
+    }
+    printf(HLINE);
+
+    printRoofline(times);
+    printf(HLINE);
+
+    /* --- Check Results --- */
+    checkSTREAMresults(dev.A, dev.B, dev.C, config.arraySize, false);
+    if (config.cpuBackend) {
+        if (cpu_errors == 0) {
+            printf("Host CPU Solution Validates\n");
+        }
+        else {
+            printf("Failed Validation of the host CPU results on %d arrays\n", cpu_errors);
+        }
+    }
+    printf(HLINE);
+
+    /* --- Export and compare results --- */
+    ResultRecord record = createResultRecord(dev, times);
+    freeDevice(dev);
+    if (!config.csvFile.empty() && !writeCSV(record, config.csvFile)) {
+        std::cerr << "Not possible to write the results to " << config.csvFile << std::endl;
+        return 1;
+    }
+    if (!config.jsonFile.empty() && !writeJSON(record, config.jsonFile)) {
+        std::cerr << "Not possible to write the results to " << config.jsonFile << std::endl;
+        return 1;
+    }
+    if (!config.baselineFile.empty()) {
+        int regressions = compareBaseline(record, config.baselineFile);
+        if (regressions == -2) {
+            std::cerr << "The baseline " << config.baselineFile << " has no row named "
+                      << record.name << "!" << std::endl;
+            return 1;
+        }
+        if (regressions < 0) {
+            std::cerr << "Not possible to read the baseline from " << config.baselineFile << std::endl;
+            return 1;
+        }
+        printf(HLINE);
+        if (regressions > 0) {
+            printf("Found %d rate(s) below the baseline!\n", regressions);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+*  Read the manifest that the Makefile writes next to the kernels
+*  (<kernel file>.manifest) into values. It contains lines KEY=VALUE with
+*  the keys STREAM_TYPE, VECTOR_WIDTH, INDEX_BITS and INDEX_TILED.
+*  Returns false if there is no manifest for the kernel file.
+*-----------------------------------------------------------------------*/
+bool readKernelManifest(const std::string& kernel_file, std::map<std::string, std::string>& values)
+{
+    return readKeyValueFile(kernel_file + ".manifest", values);
+}
+
+/*
+*  Map the content of a file read-only into memory.
+*  Returns false if the file can not be opened or is empty.
+*-----------------------------------------------------------------------*/
+bool mapFile(const std::string& file_name, MappedFile& file)
+{
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    file.data = data;
+    file.size = info.st_size;
+    return true;
+}
+
+/*
+*  64 bit FNV-1a hash of the file content and size as hexadecimal string.
+*  The content is hashed in words of 8 bytes, so also bitstreams of
+*  several hundred MB only take a fraction of a second.
+*-----------------------------------------------------------------------*/
+std::string hashFile(const MappedFile& file)
+{
+    const unsigned char* content = (const unsigned char*) file.data;
+    const cl_ulong prime = 1099511628211ULL;
+    cl_ulong hash = 14695981039346656037ULL ^ file.size;
+    size_t words = file.size / sizeof(cl_ulong);
+    for (size_t i=0; i<words; i++) {
+        cl_ulong word;
+        memcpy(&word, content + i * sizeof(cl_ulong), sizeof(cl_ulong));
+        hash = (hash ^ word) * prime;
+    }
+    for (size_t i=words * sizeof(cl_ulong); i<file.size; i++) {
+        hash = (hash ^ content[i]) * prime;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long) hash);
+    return std::string(name);
+}
+
+/*
+*  Path of the record of the programmed bitstreams. The record is kept per
+*  user in $XDG_RUNTIME_DIR, which is cleared at a reboot, or in $HOME.
+*  Returns an empty string if neither is set.
+*-----------------------------------------------------------------------*/
+std::string programmedBitstreamFile()
+{
+    const char* dir = getenv("XDG_RUNTIME_DIR");
+    if (dir != NULL && dir[0] != '\0') {
+        return std::string(dir) + "/" PROGRAMMED_BITSTREAM_FILE;
+    }
+    dir = getenv("HOME");
+    if (dir != NULL && dir[0] != '\0') {
+        return std::string(dir) + "/." PROGRAMMED_BITSTREAM_FILE;
+    }
+    return std::string();
+}
+
+/*
+*  Key of the device in the record of the programmed bitstreams. The key
+*  contains the host name, since $HOME may be shared by several nodes, and
+*  the PCIe address of the board if the runtime provides it. Otherwise the
+*  device name is used, which contains the board instance, e.g. acl0.
+*-----------------------------------------------------------------------*/
+std::string programmedDeviceKey(const cl::Device& device)
+{
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+#ifdef CL_DEVICE_PCI_BUS_INFO_KHR
+    cl_device_pci_bus_info_khr bus;
+    if (clGetDeviceInfo(device(), CL_DEVICE_PCI_BUS_INFO_KHR, sizeof(bus), &bus, NULL) == CL_SUCCESS) {
+        char address[64];
+        snprintf(address, sizeof(address), "%04x:%02x:%02x.%x", bus.pci_domain, bus.pci_bus,
+                 bus.pci_device, bus.pci_function);
+        return std::string(host) + "/" + address;
+    }
+#endif
+    return std::string(host) + "/" + device.getInfo<CL_DEVICE_NAME>();
+}
+
+/*
+*  Hash of the bitstream that this host programmed last on the device from
+*  the record of the programmed bitstreams.
+*  Returns an empty string if no bitstream is recorded for the device.
+*-----------------------------------------------------------------------*/
+std::string programmedBitstream(const cl::Device& device)
+{
+    std::string file_name = programmedBitstreamFile();
+    std::map<std::string, std::string> programmed;
+    if (file_name.empty() || !readKeyValueFile(file_name, programmed)) {
+        return std::string();
+    }
+    return programmed[programmedDeviceKey(device)];
+}
+
+/*
+*  Record the hash of the bitstream that was programmed on the device in
+*  the record of the programmed bitstreams. The entries of other devices
+*  are kept.
+*-----------------------------------------------------------------------*/
+void recordProgrammedBitstream(const cl::Device& device, const std::string& hash)
+{
+    std::string file_name = programmedBitstreamFile();
+    if (file_name.empty()) {
+        return;
+    }
+    std::map<std::string, std::string> programmed;
+    readKeyValueFile(file_name, programmed);
+    programmed[programmedDeviceKey(device)] = hash;
+    std::ofstream file(file_name.c_str());
+    for (std::map<std::string, std::string>::const_iterator it = programmed.begin();
+         it != programmed.end(); ++it) {
+        file << it->first << "=" << it->second << std::endl;
+    }
+}
+
+/*
+*  Create a context for the devices. If preloaded is set, the devices
+*  already hold the bitstream and the Intel FPGA runtime is told to use it
+*  without reprogramming. Runtimes without this mode always reprogram, in
+*  which case preloaded is reset.
+*-----------------------------------------------------------------------*/
+cl::Context createContext(const std::vector<cl::Device>& devices, bool& preloaded)
+{
+#ifdef CL_CONTEXT_COMPILER_MODE_INTELFPGA
+    if (preloaded) {
+        cl_context_properties properties[] = {
+            CL_CONTEXT_COMPILER_MODE_INTELFPGA, CL_CONTEXT_COMPILER_MODE_PRELOADED_BINARY_ONLY_INTELFPGA, 0};
+        std::cout << "Bitstream is already programmed, reprogramming is skipped" << std::endl;
+        return cl::Context(devices, properties);
+    }
+#else
+    if (preloaded) {
+        std::cout << "Bitstream is already programmed, but the runtime does not support"
+                  << " skipping the reprogramming" << std::endl;
+        preloaded = false;
+    }
+#endif
+    return cl::Context(devices);
+}
+
+/*
+*  Check that a program built from a preloaded bitstream provides the
+*  STREAM kernels with the argument metadata of the selected element type
+*  and array index. A record that does not match the bitstream on the
+*  device, e.g. after another application programmed it, fails this check.
+*-----------------------------------------------------------------------*/
+bool preloadedKernelsMatch(const cl::Program& program)
+{
+    const char* kernel_names[4] = {STREAM_COPY_KERNEL, STREAM_SCALE_KERNEL,
+                                   STREAM_ADD_KERNEL, STREAM_TRIAD_KERNEL};
+    int err;
+    for (int j=0; j<4; j++) {
+        for (int g=0; g<(config.channelKernels ? 3 : 1); g++) {
+            std::string name = std::string(kernel_names[j]) + (config.channelKernels ? groupSuffixes[g] : "");
+            cl::Kernel kernel(program, name.c_str(), &err);
+            if (err != CL_SUCCESS) {
+                return false;
+            }
+        }
+    }
+    std::string kernel_type;
+    unsigned kernel_width;
+    if (kernelArgTypes(program, kernel_type, kernel_width) && !config.elementType.empty() &&
+        (kernel_type != config.elementType || kernel_width != config.vectorWidth)) {
+        return false;
+    }
+    unsigned index_bits = kernelIndexBits(program);
+    return index_bits == 0 || index_bits == config.indexBits;
+}
+
+/*
+*  Create the context and build the program of the kernels on the device.
+*  With --skip-reprogram the device is not reprogrammed if it already holds
+*  the bitstream with the given hash and provides the expected kernels.
+*  The hash is only recorded if the device was actually programmed.
+*-----------------------------------------------------------------------*/
+void createProgram(StreamProgram& prog, const cl::Device& device, const cl::Program::Binaries& binaries,
+                   const std::string& hash)
+{
+    std::vector<cl::Device> usedDevice(1, device);
+    prog.device = device;
+    prog.preloaded = config.skipReprogram && programmedBitstream(device) == hash;
+    prog.context = createContext(usedDevice, prog.preloaded);
+
+    // Create the Program from the AOCX file.
+    prog.programTime = mysecond();
+    prog.program = cl::Program(prog.context, usedDevice, binaries);
+    int err = prog.program.build();
+    if (prog.preloaded && (err != CL_SUCCESS || !preloadedKernelsMatch(prog.program))) {
+        std::cout << "Preloaded bitstream does not provide the expected kernels, reprogramming" << std::endl;
+        prog.preloaded = false;
+        prog.context = createContext(usedDevice, prog.preloaded);
+        prog.program = cl::Program(prog.context, usedDevice, binaries);
+        prog.program.build();
+    }
+    prog.programTime = mysecond() - prog.programTime;
+#ifdef CL_CONTEXT_COMPILER_MODE_INTELFPGA
+    // Without the preloaded mode the record could never be used
+    if (!prog.preloaded) {
+        recordProgrammedBitstream(device, hash);
+    }
+#endif
+}
+
+/*
+*  Print the size of the arrays and the number of iterations.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void printArrayInfo()
+{
+    int BytesPerWord = sizeof(T);
+    printf("Array size = %llu (elements), Offset = %d (elements)\n" , (unsigned long long) config.arraySize, config.offset);
+    printf("Memory per array = %.1f MiB (= %.1f GiB).\n",
+    BytesPerWord * ( (double) config.arraySize / 1024.0/1024.0),
+    BytesPerWord * ( (double) config.arraySize / 1024.0/1024.0/1024.0));
+    printf("Total memory required = %.1f MiB (= %.1f GiB).\n",
+    (3.0 * BytesPerWord) * ( (double) config.arraySize / 1024.0/1024.),
+    (3.0 * BytesPerWord) * ( (double) config.arraySize / 1024.0/1024./1024.));
+    if (!config.adaptive) {
+        printf("Each kernel will be executed %d times.\n", config.ntimes);
+    }
+    if (config.adaptive) {
+        printf("The kernels will be executed at least %d times until the 95%% confidence\n", config.ntimes);
+        printf(" interval of the mean rates is narrower than %.2f%% or %.0f seconds passed.\n",
+               config.ciTarget, config.timeBudget);
+    }
+    printf(" The *best* time for each kernel (excluding the first %u iteration(s))\n", config.warmup);
+    printf(" will be used to compute the reported bandwidth.\n");
+    printf(HLINE);
+}
+
+/*
+*  Create the command queue, buffers and kernels for the device of the
+*  program and allocate and initialize the host arrays.
+*  Returns false if the host arrays could not be allocated.
+*-----------------------------------------------------------------------*/
+template<typename T>
+bool setupDevice(StreamDevice<T>& dev, const StreamProgram& prog)
+{
+    T scalar = 3.0;
+
+    dev.A = allocateHostArray<T>(config.arraySize);
+    dev.B = allocateHostArray<T>(config.arraySize);
+    dev.C = allocateHostArray<T>(config.arraySize);
+    if (dev.A == NULL || dev.B == NULL || dev.C == NULL) {
+        std::cerr << "Not possible to allocate the host arrays!" << std::endl;
+        return false;
+    }
+
+    //Allocates memory with value from 0 to 1000
+    parallelFor<T>(config.arraySize, [&dev](unsigned t, size_t begin, size_t end) {
+        fillArrays<T>(dev.A, dev.B, dev.C, begin, end, 1.0, 2.0, 0.0);
+    });
+
+    dev.device = prog.device;
+    dev.context = prog.context;
+    dev.program = prog.program;
+
+    //Create Command queue with profiling enabled to measure the device time
+    dev.queue = cl::CommandQueue(dev.context, dev.device, CL_QUEUE_PROFILING_ENABLE);
+
+    // create the kernels
+    dev.groups[0] = createKernelGroup(dev.program, STREAM_COPY_KERNEL);
+    dev.groups[1] = createKernelGroup(dev.program, STREAM_SCALE_KERNEL);
+    dev.groups[2] = createKernelGroup(dev.program, STREAM_ADD_KERNEL);
+    dev.groups[3] = createKernelGroup(dev.program, STREAM_TRIAD_KERNEL);
+    if (!config.channelKernels) {
+        dev.copykernel = dev.groups[0].front();
+        dev.scalekernel = dev.groups[1].front();
+        dev.addkernel = dev.groups[2].front();
+        dev.triadkernel = dev.groups[3].front();
+    }
+
+    //the kernels of a group are executed concurrently, so every kernel needs its own queue
+    dev.groupQueues.push_back(dev.queue);
+    for (size_t g=1; g<dev.groups[0].size(); g++) {
+        dev.groupQueues.push_back(cl::CommandQueue(dev.context, dev.device, CL_QUEUE_PROFILING_ENABLE));
+    }
+
+    createBuffers(dev);
+
+    //set the scalar arguments of scale and triad kernel
+    setGroupScalar(dev.groups[1], 1, scalar);
+    setGroupScalar(dev.groups[3], 3, scalar);
+    //the array size argument is set before every execution
+    setArraySize(dev, config.arraySize);
+    return true;
+}
+
+/*
+*  Create the buffers for the arrays on the banks given in config.banks and
+*  set them as arguments of the kernels. Existing buffers are replaced.
+*  The buffers contain config.offset additional elements in front of the
+*  arrays, so the arrays start at this offset on the device.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void createBuffers(StreamDevice<T>& dev)
+{
+    size_t buffer_size = sizeof(T) * (config.arraySize + config.offset);
+    dev.offset = config.offset;
+
+    //Create Buffers for input and output
+    dev.Buffer_A = cl::Buffer(dev.context, CL_MEM_READ_WRITE | bankFlag(config.banks[0]), buffer_size);
+    dev.Buffer_B = cl::Buffer(dev.context, CL_MEM_READ_WRITE | bankFlag(config.banks[1]), buffer_size);
+    dev.Buffer_C = cl::Buffer(dev.context, CL_MEM_READ_WRITE | bankFlag(config.banks[2]), buffer_size);
+
+    //set arguments of copy, scale, add and triad kernels
+    setGroupBuffers(dev.groups[0], 0, dev.Buffer_A, dev.Buffer_A, dev.Buffer_C);
+    setGroupBuffers(dev.groups[1], 1, dev.Buffer_C, dev.Buffer_C, dev.Buffer_B);
+    setGroupBuffers(dev.groups[2], 2, dev.Buffer_A, dev.Buffer_B, dev.Buffer_C);
+    setGroupBuffers(dev.groups[3], 3, dev.Buffer_B, dev.Buffer_C, dev.Buffer_A);
+}
+
+/*
+*  Create the kernels that execute the STREAM operation with the given
+*  kernel name. This is the kernel itself, or the reader, compute and
+*  writer kernel of the operation if config.channelKernels is set.
+*-----------------------------------------------------------------------*/
+std::vector<cl::Kernel> createKernelGroup(const cl::Program& program, const char* name)
+{
+    int err;
+    std::vector<cl::Kernel> group;
+    if (!config.channelKernels) {
+        group.push_back(cl::Kernel(program, name, &err));
+        assert(err==CL_SUCCESS);
+        return group;
+    }
+    for (int g=0; g<3; g++) {
+        group.push_back(cl::Kernel(program, (std::string(name) + groupSuffixes[g]).c_str(), &err));
+        assert(err==CL_SUCCESS);
+    }
+    return group;
+}
+
+/*
+*  Set the buffer arguments of the kernel group of operation j. in2 is only
+*  used by add and triad. The single kernels take the inputs followed by
+*  the output, the reader takes the inputs and the writer the output.
+*-----------------------------------------------------------------------*/
+void setGroupBuffers(std::vector<cl::Kernel>& group, int j, const cl::Buffer& in1,
+                     const cl::Buffer& in2, const cl::Buffer& out)
+{
+    int err;
+    err = group.front().setArg(0, in1);
+    assert(err==CL_SUCCESS);
+    if (groupInputs[j] == 2) {
+        err = group.front().setArg(1, in2);
+        assert(err==CL_SUCCESS);
+    }
+    if (group.size() == 1) {
+        err = group.front().setArg(groupInputs[j], out);
+    }
+    else {
+        err = group.back().setArg(0, out);
+    }
+    assert(err==CL_SUCCESS);
+}
+
+/*
+*  Set the scalar argument of the kernel group of operation j, which is
+*  only used by scale and triad.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void setGroupScalar(std::vector<cl::Kernel>& group, int j, T scalar)
+{
+    int err;
+    if (group.size() == 1) {
+        err = group.front().setArg(groupInputs[j] + 1, scalar);
+    }
+    else {
+        err = group[1].setArg(0, scalar);
+    }
+    assert(err==CL_SUCCESS);
+}
+
+/*
+*  Set an array size or offset argument of a kernel with the width of the
+*  kernel arguments, 32 or 64 bit depending on config.indexBits.
+*-----------------------------------------------------------------------*/
+void setIndexArg(cl::Kernel& kernel, cl_uint index, size_t value)
+{
+    int err;
+    if (config.indexBits == 64) {
+        err = kernel.setArg(index, (cl_ulong) value);
+    }
+    else {
+        err = kernel.setArg(index, (cl_uint) value);
+    }
+    assert(err==CL_SUCCESS);
+}
+
+/*
+*  Set the array size argument of all kernels of the group of operation j.
+*  It is the last argument of every kernel.
+*-----------------------------------------------------------------------*/
+void setGroupSize(std::vector<cl::Kernel>& group, int j, size_t array_size)
+{
+    if (group.size() == 1) {
+        setIndexArg(group.front(), groupInputs[j] + 1 + (groupScalar[j] ? 1 : 0), array_size);
+        return;
+    }
+    setIndexArg(group[0], groupInputs[j], array_size);
+    setIndexArg(group[1], groupScalar[j] ? 1 : 0, array_size);
+    setIndexArg(group[2], 1, array_size);
+}
+
+/*
+*  Set the element offset of the arrays for all kernels of the group of
+*  operation j. It is the argument after the array size of the single
+*  kernels and of the reader and writer. The compute kernel has no offset.
+*-----------------------------------------------------------------------*/
+void setGroupOffset(std::vector<cl::Kernel>& group, int j, size_t offset)
+{
+    if (group.size() == 1) {
+        setIndexArg(group.front(), groupInputs[j] + 2 + (groupScalar[j] ? 1 : 0), offset);
+        return;
+    }
+    setIndexArg(group[0], groupInputs[j] + 1, offset);
+    setIndexArg(group[2], 2, offset);
+}
+
+/*
+*  Enqueue all kernels of a group to be executed at the same time, every
+*  kernel on its own queue of dev.groupQueues. If wait_list is not NULL,
+*  the kernels start after all events of the list completed.
+*  The events of the kernels are returned in events.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void enqueueKernelGroup(StreamDevice<T>& dev, std::vector<cl::Kernel>& group,
+                        const std::vector<cl::Event>* wait_list, std::vector<cl::Event>& events)
+{
+    int err;
+    events.resize(group.size());
+    for (size_t g=0; g<group.size(); g++) {
+        err = dev.groupQueues[g].enqueueTask(group[g], wait_list, &events[g]);
+        assert(err==CL_SUCCESS);
+    }
+    for (size_t g=0; g<group.size(); g++) {
+        dev.groupQueues[g].flush();
+    }
+}
+
+/*
+*  Execute all kernels of a group at the same time and wait until all of
+*  them finished. The events of the kernels are returned in events.
+*-----------------------------------------------------------------------*/
+template<typename T>
+cl_int runKernelGroup(StreamDevice<T>& dev, std::vector<cl::Kernel>& group, std::vector<cl::Event>& events)
+{
+    enqueueKernelGroup(dev, group, NULL, events);
+    return cl::Event::waitForEvents(events);
+}
+/*
+*  Memory flag that places a buffer on the given bank. Bank 0 stands for
+*  the default placement, which is interleaved over all banks.
+*-----------------------------------------------------------------------*/
+cl_mem_flags bankFlag(unsigned bank)
+{
+    return (bank == 0) ? 0 : bankFlags[bank - 1];
+}
+
+/*
+*  True if the arrays are not placed on specific banks.
+*-----------------------------------------------------------------------*/
+bool interleavedPlacement()
+{
+    return config.banks[0] == 0 && config.banks[1] == 0 && config.banks[2] == 0;
+}
+
+/*
+*  Placement of the arrays as text, e.g. "1,2,3" or "interleaved".
+*-----------------------------------------------------------------------*/
+std::string placementName()
+{
+    if (interleavedPlacement()) {
+        return "interleaved";
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%u,%u,%u", config.banks[0], config.banks[1], config.banks[2]);
+    return name;
+}
+
+/*
+*  Parse the bank placement of the arrays A, B and C given as comma
+*  separated list of bank numbers or "interleaved" into config.banks.
+*  Returns false for invalid lists.
+*-----------------------------------------------------------------------*/
+bool parseBanks(const char * list)
+{
+    if (std::string(list) == "interleaved") {
+        for (int i=0; i<3; i++) {
+            config.banks[i] = 0;
+        }
+        return true;
+    }
+    unsigned banks[3];
+    char end;
+    if (sscanf(list, "%u,%u,%u%c", &banks[0], &banks[1], &banks[2], &end) != 3) {
+        return false;
+    }
+    for (int i=0; i<3; i++) {
+        if (banks[i] < 1 || banks[i] > 4) {
+            return false;
+        }
+        config.banks[i] = banks[i];
+    }
+    return true;
+}
+/*
+*  Read the lines KEY=VALUE of a file into values.
+*  Returns false if the file can not be opened.
+*-----------------------------------------------------------------------*/
+bool readKeyValueFile(const std::string& file_name, std::map<std::string, std::string>& values)
+{
+    std::ifstream file(file_name.c_str());
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) {
+            continue;
+        }
+        values[line.substr(0, separator)] = line.substr(separator + 1);
+    }
+    return true;
+}
+
+/*
+*  Select the element type and vector width of the kernels. They are taken
+*  from --type and --vector-width or from the manifest of the kernel file,
+*  in this order. Without any of them, config.elementType stays empty and
+*  the type is taken from the argument metadata of the kernels, see
+*  checkKernelTypes(), or the type the host was built with is used.
+*  Returns false for unsupported types or vector widths.
+*-----------------------------------------------------------------------*/
+bool selectElementType()
+{
+    std::map<std::string, std::string> manifest;
+    if (config.elementType.empty() && readKernelManifest(config.kernelFile, manifest)) {
+        config.elementType = manifest["STREAM_TYPE"];
+        if (manifest.count("VECTOR_WIDTH") > 0) {
+            config.vectorWidth = strtoul(manifest["VECTOR_WIDTH"].c_str(), NULL, 10);
+        }
+        std::cout << "Read element type " << config.elementType << " and vector width "
+                  << config.vectorWidth << " from " << config.kernelFile << ".manifest" << std::endl;
+    }
+    const char* kernel_types[] = {"half", "float", "double", "int", "long"};
+    bool supported = config.elementType.empty();
+    for (int i=0; i<5; i++) {
+        supported = supported || config.elementType == kernel_types[i];
+    }
+    if (!supported) {
+        std::cerr << "Element type " << config.elementType << " is not supported!" << std::endl;
+        return false;
+    }
+    if (config.vectorWidth == 0 || config.vectorWidth > 16) {
+        std::cerr << "The vector width has to be between 1 and 16!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+*  Select the width of the array size and offset arguments of the STREAM
+*  kernels from the --index-bits option or from the manifest of the kernel
+*  file, otherwise 32 bit are used. The manifest also tells if the kernels
+*  process the arrays in tiles with 32 bit loop counters.
+*  Returns false if the array size and offset can not be addressed.
+*-----------------------------------------------------------------------*/
+bool selectIndexBits()
+{
+    std::map<std::string, std::string> manifest;
+    if (readKernelManifest(config.kernelFile, manifest)) {
+        if (config.indexBits == 0 && manifest.count("INDEX_BITS") > 0) {
+            config.indexBits = strtoul(manifest["INDEX_BITS"].c_str(), NULL, 10);
+        }
+        config.indexTiled = manifest["INDEX_TILED"] == "1";
+    }
+    if (config.indexBits == 0) {
+        config.indexBits = 32;
+    }
+    if (config.indexBits != 32 && config.indexBits != 64) {
+        std::cerr << "The array index has to be 32 or 64 bit!" << std::endl;
+        return false;
+    }
+    if (config.arraySize + config.offset > maxKernelIndex()) {
+        std::cerr << "Array size and offset exceed the 32 bit arguments of the kernels!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+*  Largest sum of array size and offset that the kernels of the selected
+*  mode can address. The kernels of the access sweep and the read-write mode
+*  always use 32 bit arguments.
+*-----------------------------------------------------------------------*/
+size_t maxKernelIndex()
+{
+    if (config.mode == MODE_CPU ||
+        (config.indexBits == 64 && config.mode != MODE_ACCESS && config.mode != MODE_READ_WRITE)) {
+        return std::numeric_limits<size_t>::max();
+    }
+    return UINT_MAX;
+}
+
+/*
+*  Description of the array index of the kernels for the output.
+*-----------------------------------------------------------------------*/
+std::string indexName()
+{
+    if (config.indexBits == 32) {
+        return "32 bit";
+    }
+    return config.indexTiled ? "64 bit, 32 bit loop counter in tiles" : "64 bit";
+}
+
+/*
+*  Read the kernel fMax in MHz from the Quartus report that aoc writes into
+*  the project directory of the kernels, e.g. bin/stream_kernels for
+*  bin/stream_kernels.aocx. Returns false if there is no report.
+*-----------------------------------------------------------------------*/
+bool readReportFmax(const std::string& kernel_file, double& fmax)
+{
+    std::string project = kernel_file.substr(0, kernel_file.rfind(".aocx"));
+    std::ifstream report((project + "/acl_quartus_report.txt").c_str());
+    std::string line;
+    while (std::getline(report, line)) {
+        size_t found = line.find("Kernel fmax:");
+        if (found != std::string::npos) {
+            fmax = strtod(line.c_str() + found + strlen("Kernel fmax:"), NULL);
+            return fmax > 0.0;
+        }
+    }
+    return false;
+}
+
+/*
+*  Element type and vector width of the kernels from the argument metadata
+*  of scale, e.g. "double" and 8 for an array argument of type double8*.
+*  Returns false if the runtime provides no argument metadata.
+*-----------------------------------------------------------------------*/
+bool kernelArgTypes(const cl::Program& program, std::string& type, unsigned& width)
+{
+    int err;
+    std::vector<cl::Kernel> scale = createKernelGroup(program, STREAM_SCALE_KERNEL);
+    // the scalar is the third argument of scale or the first of scale_compute
+    std::string scalar_type = (scale.size() == 1) ?
+                              scale.front().getArgInfo<CL_KERNEL_ARG_TYPE_NAME>(2, &err) :
+                              scale[1].getArgInfo<CL_KERNEL_ARG_TYPE_NAME>(0, &err);
+    if (err != CL_SUCCESS || scalar_type.empty()) {
+        return false;
+    }
+    std::string array_type = scale.front().getArgInfo<CL_KERNEL_ARG_TYPE_NAME>(0, &err);
+    if (err != CL_SUCCESS || array_type.empty()) {
+        return false;
+    }
+    type = scalar_type.substr(0, scalar_type.find_first_not_of("abcdefghijklmnopqrstuvwxyz"));
+    size_t digits = array_type.find_first_of("0123456789");
+    width = (digits == std::string::npos) ? 1 : strtoul(array_type.c_str() + digits, NULL, 10);
+    return true;
+}
+
+/*
+*  Width of the array size argument of the kernels from the argument
+*  metadata of copy, 32 for uint and 64 for ulong.
+*  Returns 0 if the runtime provides no argument metadata.
+*-----------------------------------------------------------------------*/
+unsigned kernelIndexBits(const cl::Program& program)
+{
+    int err;
+    std::vector<cl::Kernel> copy = createKernelGroup(program, STREAM_COPY_KERNEL);
+    // the array size follows both arrays of copy or the input of copy_read
+    cl_uint arg = groupInputs[0] + ((copy.size() == 1) ? 1 : 0);
+    std::string size_type = copy.front().getArgInfo<CL_KERNEL_ARG_TYPE_NAME>(arg, &err);
+    if (err != CL_SUCCESS) {
+        return 0;
+    }
+    if (size_type == "ulong") {
+        return 64;
+    }
+    return (size_type == "uint") ? 32 : 0;
+}
+
+/*
+*  Check the selected element type, vector width and array index against
+*  the argument metadata of the kernels. If no element type was selected,
+*  the element type and vector width of the kernels are used.
+*  Returns false if the kernels do not match the selection.
+*-----------------------------------------------------------------------*/
+bool checkKernelTypes(const cl::Program& program)
+{
+    std::string kernel_type;
+    unsigned kernel_width;
+    if (kernelArgTypes(program, kernel_type, kernel_width) &&
+        (kernel_type != config.elementType || kernel_width != config.vectorWidth)) {
+        if (!config.elementType.empty()) {
+            std::cerr << "The kernels use " << kernel_type << " with vector width " << kernel_width
+                      << " instead of " << config.elementType << " with vector width "
+                      << config.vectorWidth << "!" << std::endl;
+            return false;
+        }
+        config.elementType = kernel_type;
+        config.vectorWidth = kernel_width;
+        std::cout << "Read element type " << config.elementType << " and vector width "
+                  << config.vectorWidth << " from the argument metadata of the kernels" << std::endl;
+    }
+    unsigned index_bits = kernelIndexBits(program);
+    if (index_bits != 0 && index_bits != config.indexBits) {
+        std::cerr << "The kernels use " << index_bits << " bit array sizes instead of "
+                  << config.indexBits << " bit, see --index-bits!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+*  Free the host arrays of the device.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void freeDevice(StreamDevice<T>& dev)
+{
+    free(dev.A);
+    free(dev.B);
+    free(dev.C);
+}
+
+/*
+*  Set the number of elements that is processed by the STREAM kernels and
+*  the offset of the arrays in the buffers given by dev.offset.
+*  Both together have to fit into the size the buffers were created with.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void setArraySize(StreamDevice<T>& dev, size_t array_size)
+{
+    for (int j=0; j<4; j++) {
+        setGroupSize(dev.groups[j], j, array_size);
+        setGroupOffset(dev.groups[j], j, dev.offset);
+    }
+}
+
+/*
+*  Execute config.ntimes iterations of the benchmark on the first array_size
+*  elements of the arrays. Every iteration writes A, B and C to the device,
+*  executes the four kernels one after another and reads the arrays back.
+*  The measured times are stored in times[0..5][iteration] in the order of
+*  the labels. If a barrier is given, it is waited for before every iteration.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void executeIterations(StreamDevice<T>& dev, size_t array_size,
+                       StreamTimings& times, bool verbose, ThreadBarrier* barrier)
+{
+    for (unsigned k=0; k < config.ntimes; k++) {
+        if (verbose) {
+            std::cout << "Execute iteration " << (k + 1) << " of " << config.ntimes << std::endl;
+        }
+        if (barrier != NULL) {
+            barrier->wait();
+        }
+        executeIteration(dev, array_size, times, k);
+    }
+}
+
+/*
+*  Execute a single iteration of the transfers and kernels and store the
+*  times as iteration k. times has to contain at least k + 1 iterations.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void executeIteration(StreamDevice<T>& dev, size_t array_size, StreamTimings& times, unsigned k)
+{
+    int err;
+    std::vector<cl::Event> transfers(3);
+    size_t buffer_size = sizeof(T) * array_size;
+    size_t offset_bytes = sizeof(T) * dev.offset;
+    //Write data to device
+    times.wall[4][k] = mysecond();
+    dev.queue.enqueueWriteBuffer(dev.Buffer_A, CL_FALSE, offset_bytes, buffer_size, dev.A, NULL, &transfers[0]);
+    dev.queue.enqueueWriteBuffer(dev.Buffer_B, CL_FALSE, offset_bytes, buffer_size, dev.B, NULL, &transfers[1]);
+    dev.queue.enqueueWriteBuffer(dev.Buffer_C, CL_FALSE, offset_bytes, buffer_size, dev.C, NULL, &transfers[2]);
+    err = dev.queue.finish();
+    times.wall[4][k] = mysecond() - times.wall[4][k];
+    recordProfiling(times, 4, k, transfers);
+
+    assert(err==CL_SUCCESS);
+
+    // execute copy, scale, add and triad one after another
+    for (int j=0; j<4; j++) {
+        std::vector<cl::Event> events;
+        times.wall[j][k] = mysecond();
+        err = runKernelGroup(dev, dev.groups[j], events);
+        times.wall[j][k] = mysecond() - times.wall[j][k];
+        recordProfiling(times, j, k, events);
+        assert(err==CL_SUCCESS);
+    }
+
+    // read the output
+    times.wall[5][k] = mysecond();
+    dev.queue.enqueueReadBuffer(dev.Buffer_A, CL_FALSE, offset_bytes, buffer_size, dev.A, NULL, &transfers[0]);
+    dev.queue.enqueueReadBuffer(dev.Buffer_B, CL_FALSE, offset_bytes, buffer_size, dev.B, NULL, &transfers[1]);
+    dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_FALSE, offset_bytes, buffer_size, dev.C, NULL, &transfers[2]);
+    err=dev.queue.finish();
+    times.wall[5][k] = mysecond() - times.wall[5][k];
+    recordProfiling(times, 5, k, transfers);
+    assert(err==CL_SUCCESS);
+
+}
+
+/*
+*  Execute iterations until the 95% confidence interval of the mean rate
+*  of every kernel and transfer is narrower than config.ciTarget percent
+*  of the mean or config.timeBudget seconds passed. At least config.ntimes
+*  iterations are executed. The number of iterations is also limited by
+*  maxValidIterations(), so the results can still be validated.
+*  Returns the number of executed iterations.
+*-----------------------------------------------------------------------*/
+template<typename T>
+unsigned executeAdaptive(StreamDevice<T>& dev, StreamTimings& times)
+{
+    unsigned max_iterations = maxValidIterations<T>();
+    double start = mysecond();
+    unsigned k = 0;
+    while (k < max_iterations) {
+        times.resize(k + 1);
+        executeIteration(dev, config.arraySize, times, k);
+        k++;
+        // The standard deviation needs at least two samples after the warm-up
+        if (k < MAX(config.ntimes, config.warmup + 2)) {
+            continue;
+        }
+        double widest = 0.0;
+        for (int j=0; j<6; j++) {
+            TimeStatistics stats = timeStatistics(times.wall[j]);
+            // relative width of the interval of the rate bytes / time
+            double width = (stats.ciLow > 0.0) ?
+                           100.0 * (1.0 / stats.ciLow - 1.0 / stats.ciHigh) * stats.avg : INFINITY;
+            widest = MAX(widest, width);
+        }
+        std::cout << "Execute iteration " << k << ": widest confidence interval "
+                  << widest << "%" << std::endl;
+        if (widest <= config.ciTarget) {
+            break;
+        }
+        if (mysecond() - start > config.timeBudget) {
+            std::cout << "Time budget exceeded before reaching the target confidence interval" << std::endl;
+            break;
+        }
+    }
+    if (k == max_iterations) {
+        std::cout << "Stopped after " << k << " iterations, more iterations would overflow " << StreamTypeName<T>::host()
+                  << " in the validation" << std::endl;
+    }
+    return k;
+}
+
+/*
+*  The values of the arrays grow with every iteration of the kernels.
+*  Return the number of iterations that can be executed before the values
+*  expected by checkSTREAMresults() overflow T. This limits
+*  half and int to a few iterations.
+*-----------------------------------------------------------------------*/
+template<typename T>
+unsigned maxValidIterations()
+{
+    // calculated in double, so the integer types do not overflow here
+    double aj = 2.0, bj = 2.0, cj = 0.0, scalar = 3.0;
+    unsigned k = 0;
+    while (true) {
+        cj = aj;
+        bj = scalar*cj;
+        cj = aj+bj;
+        aj = bj+scalar*cj;
+        if (!isfinite(aj) || aj > (double) std::numeric_limits<T>::max()) {
+            return k;
+        }
+        k++;
+    }
+}
+
+/*
+*  Store the profiling information of the given events as timing of
+*  label j in iteration k. The events have to be completed and are expected
+*  to be executed one after another on the same queue.
+*-----------------------------------------------------------------------*/
+void recordProfiling(StreamTimings& times, int j, unsigned k, const std::vector<cl::Event>& events)
+{
+    cl_ulong queued = events.front().getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>();
+    cl_ulong submit = events.front().getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>();
+    cl_ulong start = events.front().getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    cl_ulong end = events.back().getProfilingInfo<CL_PROFILING_COMMAND_END>();
+    // concurrent kernels of a group may start and end in any order
+    for (size_t i=1; i<events.size(); i++) {
+        queued = MIN(queued, events[i].getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>());
+        submit = MIN(submit, events[i].getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>());
+        start = MIN(start, events[i].getProfilingInfo<CL_PROFILING_COMMAND_START>());
+        end = MAX(end, events[i].getProfilingInfo<CL_PROFILING_COMMAND_END>());
+    }
+    times.queued[j][k] = 1.0E-9 * (submit - queued);
+    times.submitted[j][k] = 1.0E-9 * (start - submit);
+    times.device[j][k] = 1.0E-9 * (end - start);
+}
+
+/*
+*  Check if the commands of the events were executed at the same time,
+*  i.e. the last command started before the first command ended.
+*-----------------------------------------------------------------------*/
+bool eventsOverlap(const std::vector<cl::Event>& events)
+{
+    cl_ulong last_start = 0;
+    cl_ulong first_end = std::numeric_limits<cl_ulong>::max();
+    for (size_t i=0; i<events.size(); i++) {
+        last_start = MAX(last_start, events[i].getProfilingInfo<CL_PROFILING_COMMAND_START>());
+        first_end = MIN(first_end, events[i].getProfilingInfo<CL_PROFILING_COMMAND_END>());
+    }
+    return last_start < first_end;
+}
+
+/*
+*  Minimum, average and maximum of the given times excluding the first
+*  config.warmup iterations.
+*-----------------------------------------------------------------------*/
+double minTime(const std::vector<double>& times)
+{
+    double min_time = FLT_MAX;
+    for (size_t k=config.warmup; k<times.size(); k++) { /* note -- skip warm-up iterations */
+        min_time = MIN(min_time, times[k]);
+    }
+    return min_time;
+}
+
+double avgTime(const std::vector<double>& times)
+{
+    double sum = 0.0;
+    for (size_t k=config.warmup; k<times.size(); k++) { /* note -- skip warm-up iterations */
+        sum += times[k];
+    }
+    return sum / (double) (times.size() - config.warmup);
+}
+
+double maxTime(const std::vector<double>& times)
+{
+    double max_time = 0.0;
+    for (size_t k=config.warmup; k<times.size(); k++) { /* note -- skip warm-up iterations */
+        max_time = MAX(max_time, times[k]);
+    }
+    return max_time;
+}
+
+/*
+*  Calculate the statistics of the given times excluding the warm-up
+*  iterations. The percentiles use the nearest rank of the sorted times.
+*  The confidence interval uses the Student t-distribution.
+*-----------------------------------------------------------------------*/
+TimeStatistics timeStatistics(const std::vector<double>& times)
+{
+    // two-sided 95% quantiles of the t-distribution for 1 to 30 degrees of freedom
+    static const double t_quantile[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+    TimeStatistics stats;
+    std::vector<double> sorted(times.begin() + MIN((size_t) config.warmup, times.size()), times.end());
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    stats.samples = n;
+    stats.min = minTime(times);
+    stats.avg = avgTime(times);
+    stats.max = maxTime(times);
+
+    double sq_sum = 0.0;
+    for (size_t k=0; k<n; k++) {
+        sq_sum += (sorted[k] - stats.avg) * (sorted[k] - stats.avg);
+    }
+    stats.stddev = (n > 1) ? sqrt(sq_sum / (double) (n - 1)) : 0.0;
+
+    stats.median = (n % 2 == 1) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+    stats.p95 = sorted[MIN((size_t) ceil(0.95 * n), n) - 1];
+    stats.p99 = sorted[MIN((size_t) ceil(0.99 * n), n) - 1];
+
+    double t = (n > 30) ? 1.96 : t_quantile[MAX(n, (size_t) 2) - 2];
+    double half_width = t * stats.stddev / sqrt((double) n);
+    stats.ciLow = stats.avg - half_width;
+    stats.ciHigh = stats.avg + half_width;
+    return stats;
+}
+
+/*
+*  Compare the best rates of the STREAM kernels with their theoretical peak.
+*  The memory peak is the bandwidth of the banks that hold the arrays of a
+*  kernel, each with config.ddrSpeed MT/s and DDR_BUS_WIDTH bytes. The
+*  pipeline peak is the bandwidth of UNROLL_COUNT elements per cycle at the
+*  kernel fMax, twice as much for copy and scale of stream_kernels_vec.cl.
+*  The lower peak bounds the kernel. As all kernels stream their arrays in
+*  the same way, kernels whose efficiency is below ANOMALY_THRESHOLD of the
+*  most efficient kernel are flagged, as are rates above the peak.
+*-----------------------------------------------------------------------*/
+void printRoofline(const StreamTimings& times)
+{
+    // arrays A, B and C that are accessed by copy, scale, add and triad
+    const int kernel_arrays[4][3] = {{0, 2, -1}, {2, 1, -1}, {0, 1, 2}, {1, 2, 0}};
+    double bank_rate = config.ddrSpeed * DDR_BUS_WIDTH;
+    double elements_per_cycle = 0.0;
+#ifdef UNROLL_COUNT
+    elements_per_cycle = UNROLL_COUNT;
+#endif
+    bool pipeline_known = config.fmax > 0.0 && elements_per_cycle > 0.0;
+
+    printf("Theoretical peak in MB/s with %.0f MT/s and %d bytes per bank", config.ddrSpeed, DDR_BUS_WIDTH);
+    if (pipeline_known) {
+        printf(" and %.0f elements per cycle at %.1f MHz:\n", elements_per_cycle, config.fmax);
+    }
+    else {
+        printf(",\npipeline peak unknown without the kernel fMax and UNROLL_COUNT:\n");
+    }
+    printf("Function    Rate MB/s  Banks  Memory MB/s  Pipeline MB/s  Efficiency  Bound\n");
+    double rates[4], efficiency[4];
+    double max_efficiency = 0.0;
+    for (int j=0; j<4; j++) {
+        unsigned banks = 0;
+        if (interleavedPlacement()) {
+            banks = config.numBanks;
+        }
+        else {
+            for (int a=0; a<3 && kernel_arrays[j][a] >= 0; a++) {
+                unsigned bank = config.banks[kernel_arrays[j][a]];
+                bool counted = false;
+                for (int b=0; b<a; b++) {
+                    counted = counted || config.banks[kernel_arrays[j][b]] == bank;
+                }
+                banks += counted ? 0 : 1;
+            }
+        }
+        double memory_rate = banks * bank_rate;
+        double pipeline_rate = 0.0;
+        if (pipeline_known) {
+            double cycle_elements = (config.vectorWidth > 1 && j < 2) ? 2 * elements_per_cycle : elements_per_cycle;
+            pipeline_rate = config.fmax * cycle_elements * bytes[j] / config.arraySize;
+        }
+        bool pipeline_bound = pipeline_known && pipeline_rate < memory_rate;
+        double peak = pipeline_bound ? pipeline_rate : memory_rate;
+        rates[j] = 1.0E-06 * bytes[j] / minTime(times.wall[j]);
+        efficiency[j] = rates[j] / peak;
+        max_efficiency = MAX(max_efficiency, efficiency[j]);
+        printf("%s%10.1f  %5u  %11.1f  ", label[j].c_str(), rates[j], banks, memory_rate);
+        if (pipeline_known) {
+            printf("%13.1f", pipeline_rate);
+        }
+        else {
+            printf("%13s", "-");
+        }
+        printf("  %9.1f%%  %s\n", 100.0 * efficiency[j], pipeline_bound ? "pipeline" : "memory");
+    }
+
+    for (int j=0; j<4; j++) {
+        std::string name = label[j].substr(0, label[j].find(':'));
+        if (efficiency[j] > 1.0) {
+            printf("Anomaly: %s exceeds the theoretical peak, check the DDR speed, banks and fMax\n",
+                   name.c_str());
+        }
+        else if (efficiency[j] < ANOMALY_THRESHOLD * max_efficiency) {
+            printf("Anomaly: %s reaches only %.1f%% of the efficiency of the best kernel\n",
+                   name.c_str(), 100.0 * efficiency[j] / max_efficiency);
+        }
+    }
+}
+
+/*
+*  Print a row with the statistics of the given times. The confidence
+*  interval of the mean time is converted to an interval of the rate.
+*-----------------------------------------------------------------------*/
+void printStatistics(const std::string& label, const std::vector<double>& times, double label_bytes)
+{
+    TimeStatistics stats = timeStatistics(times);
+    printf("%s%7llu  %11.6f  %11.6f  %11.6f  %11.6f  %10.1f - %.1f\n", label.c_str(),
+           (unsigned long long) stats.samples, stats.median, stats.stddev, stats.p95, stats.p99,
+           1.0E-06 * label_bytes / stats.ciHigh,
+           stats.ciLow > 0.0 ? 1.0E-06 * label_bytes / stats.ciLow : INFINITY);
+}
+
+/*
+*  Execute the benchmark for a geometric series of array sizes starting
+*  with config.sweepMinSize up to config.arraySize elements.
+*  The context, program, kernels and buffers are reused for all sizes, so
+*  the FPGA is programmed only once. For every size one row with the best
+*  rates of all kernels and transfers is printed. For the kernels the rate
+*  is given for the device time and the end-to-end time measured on the host.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runSweep(StreamDevice<T>& dev)
+{
+    StreamTimings times(config.ntimes);
+
+    printf("Sweep over array sizes from %llu to %llu elements (factor %.2f)\n",
+           (unsigned long long) config.sweepMinSize, (unsigned long long) config.arraySize,
+           config.sweepFactor);
+    printf(HLINE);
+    printf("Rates in MB/s. Kernels: device time (dev) and end-to-end time (e2e)\n");
+    printf("%12s %12s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s %6s\n", "Elements", "Bytes/array",
+           "Copy dev", "Copy e2e", "Scale dev", "Scale e2e", "Add dev", "Add e2e",
+           "Triad dev", "Triad e2e", "PCI Write", "PCI Read", "Valid");
+
+    size_t array_size = config.sweepMinSize;
+    while (true) {
+        initializeArrays(dev.A, dev.B, dev.C, array_size);
+        setArraySize(dev, array_size);
+        executeIterations(dev, array_size, times, false, NULL);
+
+        printf("%12llu %12llu", (unsigned long long) array_size,
+               (unsigned long long) (sizeof(T) * array_size));
+        for (int j=0; j<6; j++) {
+            double size_bytes = ((j == 0 || j == 1) ? 2 : 3) * sizeof(T) * (double) array_size;
+            if (j < 4) {
+                printf(" %10.1f", 1.0E-06 * size_bytes / minTime(times.device[j]));
+            }
+            printf(" %10.1f", 1.0E-06 * size_bytes / minTime(times.wall[j]));
+        }
+        printf(" %6s\n", checkSTREAMresults(dev.A, dev.B, dev.C, array_size, true) == 0 ? "yes" : "no");
+        fflush(stdout);
+
+        if (array_size >= config.arraySize) {
+            break;
+        }
+        // Next size is rounded to a multiple of the vector width used in the kernels
+        size_t step = 2 * config.vectorWidth;
+        size_t next_size = (size_t) (array_size * config.sweepFactor);
+        next_size -= next_size % step;
+        array_size = MIN(MAX(next_size, array_size + step), config.arraySize);
+    }
+    printf(HLINE);
+    setArraySize(dev, config.arraySize);
+}
+
+/*
+*  Execute the four kernels concurrently. Every kernel gets its own command
+*  queue and its own set of buffers. If the arrays are placed on specific
+*  banks, the buffers of kernel i are placed on bank i+1, so the kernels do
+*  not share a memory bank.
+*  All kernels are enqueued before any of the queues is flushed, so they are
+*  started at nearly the same time. The aggregate rate is calculated from
+*  the bytes of all kernels and the time from the first START to the last END.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runConcurrent(StreamDevice<T>& dev)
+{
+    int err;
+    const char* kernel_names[4] = {STREAM_COPY_KERNEL, STREAM_SCALE_KERNEL,
+                                   STREAM_ADD_KERNEL, STREAM_TRIAD_KERNEL};
+    // number of input arrays of the kernels, every kernel has one output array
+    const int num_inputs[4] = {1, 1, 2, 2};
+    T scalar = 3.0;
+    size_t buffer_size = sizeof(T) * config.arraySize;
+
+    std::vector<cl::CommandQueue> queues(4);
+    std::vector<cl::Kernel> kernels(4);
+    std::vector<std::vector<cl::Buffer> > buffers(4);
+    for (int i=0; i<4; i++) {
+        cl_mem_flags flags = CL_MEM_READ_WRITE | (interleavedPlacement() ? 0 : bankFlag(i % config.numBanks + 1));
+        queues[i] = cl::CommandQueue(dev.context, dev.device, CL_QUEUE_PROFILING_ENABLE);
+        kernels[i] = cl::Kernel(dev.program, kernel_names[i], &err);
+        assert(err==CL_SUCCESS);
+        for (int b=0; b<=num_inputs[i]; b++) {
+            buffers[i].push_back(cl::Buffer(dev.context, flags, buffer_size));
+            err = kernels[i].setArg(b, buffers[i][b]);
+            assert(err==CL_SUCCESS);
+        }
+        // scale and triad get the scalar before the array size
+        int arg = num_inputs[i] + 1;
+        if (i == 1 || i == 3) {
+            err = kernels[i].setArg(arg++, scalar);
+            assert(err==CL_SUCCESS);
+        }
+        setIndexArg(kernels[i], arg, config.arraySize);
+        setIndexArg(kernels[i], arg + 1, 0);
+
+        // inputs are initialized with the values of A and B
+        err = queues[i].enqueueWriteBuffer(buffers[i][0], CL_TRUE, 0, buffer_size, dev.A);
+        assert(err==CL_SUCCESS);
+        if (num_inputs[i] == 2) {
+            err = queues[i].enqueueWriteBuffer(buffers[i][1], CL_TRUE, 0, buffer_size, dev.B);
+            assert(err==CL_SUCCESS);
+        }
+    }
+
+    double kernel_bytes[4];
+    double total_bytes = 0.0;
+    for (int i=0; i<4; i++) {
+        kernel_bytes[i] = bytes[i];
+        total_bytes += bytes[i];
+    }
+
+    StreamTimings times(config.ntimes);
+    std::vector<double> aggregate_wall(config.ntimes), aggregate_device(config.ntimes);
+    std::vector<std::vector<double> > start_offset(4, std::vector<double>(config.ntimes));
+    std::vector<cl::Event> events(4);
+
+    printf("Concurrent execution of all kernels on separate queues\n");
+    if (interleavedPlacement()) {
+        printf("Buffers are interleaved over all banks\n");
+    }
+    else {
+        printf("Buffers of copy, scale, add and triad are placed on separate banks\n");
+    }
+    printf(HLINE);
+    for (unsigned k=0; k<config.ntimes; k++) {
+        std::cout << "Execute iteration " << (k + 1) << " of " << config.ntimes << std::endl;
+        double t = mysecond();
+        for (int i=0; i<4; i++) {
+            err = queues[i].enqueueTask(kernels[i], NULL, &events[i]);
+            assert(err==CL_SUCCESS);
+        }
+        for (int i=0; i<4; i++) {
+            queues[i].flush();
+        }
+        for (int i=0; i<4; i++) {
+            err = queues[i].finish();
+            assert(err==CL_SUCCESS);
+        }
+        t = mysecond() - t;
+
+        cl_ulong first_start = ULLONG_MAX, last_end = 0;
+        for (int i=0; i<4; i++) {
+            first_start = MIN(first_start, events[i].getProfilingInfo<CL_PROFILING_COMMAND_START>());
+            last_end = MAX(last_end, events[i].getProfilingInfo<CL_PROFILING_COMMAND_END>());
+        }
+        for (int i=0; i<4; i++) {
+            times.wall[i][k] = t;
+            recordProfiling(times, i, k, std::vector<cl::Event>(1, events[i]));
+            start_offset[i][k] = 1.0E-9 * (events[i].getProfilingInfo<CL_PROFILING_COMMAND_START>() - first_start);
+        }
+        aggregate_wall[k] = t;
+        aggregate_device[k] = 1.0E-9 * (last_end - first_start);
+    }
+
+    printf("Function    Device MB/s  Avg device time  Avg start offset (us)\n");
+    for (int i=0; i<4; i++) {
+        printf("%s%11.1f  %15.6f  %21.1f\n", label[i].c_str(),
+               1.0E-06 * kernel_bytes[i] / minTime(times.device[i]),
+               avgTime(times.device[i]),
+               1.0E6 * avgTime(start_offset[i]));
+    }
+    printf("Aggregate:  %11.1f  %15.6f\n", 1.0E-06 * total_bytes / minTime(aggregate_device),
+           avgTime(aggregate_device));
+    printf("Aggregate end-to-end rate: %.1f MB/s\n", 1.0E-06 * total_bytes / minTime(aggregate_wall));
+    printf(HLINE);
+
+    // validate the outputs of all kernels
+    T expected[4] = {dev.A[0], scalar * dev.A[0], dev.A[0] + dev.B[0], dev.A[0] + scalar * dev.B[0]};
+    int errors = 0;
+    for (int i=0; i<4; i++) {
+        err = queues[i].enqueueReadBuffer(buffers[i][num_inputs[i]], CL_TRUE, 0, buffer_size, dev.C);
+        assert(err==CL_SUCCESS);
+        size_t ierr = 0;
+        for (size_t j=0; j<config.arraySize; j++) {
+            if (dev.C[j] != expected[i]) {
+                ierr++;
+            }
+        }
+        if (ierr > 0) {
+            errors++;
+            printf("Failed Validation of %s %llu errors were found.\n", label[i].c_str(),
+                   (unsigned long long) ierr);
+        }
+    }
+    if (errors == 0) {
+        printf("Solution Validates: all outputs of the concurrent kernels are correct\n");
+    }
+    printf(HLINE);
+}
+
+/*
+*  Execute the benchmark as an end-to-end stream over PCIe.
+*  The arrays are split into chunks of config.chunkSize elements. The
+*  chunks are processed with config.chunkBuffers sets of device buffers and
+*  three command queues for the writes, the kernels and the reads, so the
+*  upload of chunk i+1 overlaps the kernels of chunk i and the download of
+*  chunk i-1. A buffer set is reused as soon as the previous chunk in it was
+*  read back. Every iteration streams the whole arrays through the device.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runPipeline(StreamDevice<T>& dev)
+{
+    int err;
+    T scalar = 3.0;
+    unsigned num_slots = config.chunkBuffers;
+    size_t chunk_size = MIN(config.chunkSize, config.arraySize);
+    size_t num_chunks = (config.arraySize + chunk_size - 1) / chunk_size;
+    size_t chunk_bytes = sizeof(T) * chunk_size;
+
+    cl::CommandQueue write_queue(dev.context, dev.device, CL_QUEUE_PROFILING_ENABLE);
+    cl::CommandQueue compute_queue(dev.context, dev.device, CL_QUEUE_PROFILING_ENABLE);
+    cl::CommandQueue read_queue(dev.context, dev.device, CL_QUEUE_PROFILING_ENABLE);
+
+    // one set of buffers and kernels for every slot
+    std::vector<StreamDevice<T> > slots(num_slots);
+    for (unsigned s=0; s<num_slots; s++) {
+        slots[s].Buffer_A = cl::Buffer(dev.context, CL_MEM_READ_WRITE, chunk_bytes);
+        slots[s].Buffer_B = cl::Buffer(dev.context, CL_MEM_READ_WRITE, chunk_bytes);
+        slots[s].Buffer_C = cl::Buffer(dev.context, CL_MEM_READ_WRITE, chunk_bytes);
+        slots[s].copykernel = cl::Kernel(dev.program, STREAM_COPY_KERNEL, &err);
+        assert(err==CL_SUCCESS);
+        slots[s].scalekernel = cl::Kernel(dev.program, STREAM_SCALE_KERNEL, &err);
+        assert(err==CL_SUCCESS);
+        slots[s].addkernel = cl::Kernel(dev.program, STREAM_ADD_KERNEL, &err);
+        assert(err==CL_SUCCESS);
+        slots[s].triadkernel = cl::Kernel(dev.program, STREAM_TRIAD_KERNEL, &err);
+        assert(err==CL_SUCCESS);
+        slots[s].copykernel.setArg(0, slots[s].Buffer_A);
+        slots[s].copykernel.setArg(1, slots[s].Buffer_C);
+        slots[s].scalekernel.setArg(0, slots[s].Buffer_C);
+        slots[s].scalekernel.setArg(1, slots[s].Buffer_B);
+        slots[s].scalekernel.setArg(2, scalar);
+        slots[s].addkernel.setArg(0, slots[s].Buffer_A);
+        slots[s].addkernel.setArg(1, slots[s].Buffer_B);
+        slots[s].addkernel.setArg(2, slots[s].Buffer_C);
+        slots[s].triadkernel.setArg(0, slots[s].Buffer_B);
+        slots[s].triadkernel.setArg(1, slots[s].Buffer_C);
+        slots[s].triadkernel.setArg(2, slots[s].Buffer_A);
+        slots[s].triadkernel.setArg(3, scalar);
+        // setArraySize() sets the size and offset over the kernel groups
+        slots[s].offset = 0;
+        slots[s].groups[0].push_back(slots[s].copykernel);
+        slots[s].groups[1].push_back(slots[s].scalekernel);
+        slots[s].groups[2].push_back(slots[s].addkernel);
+        slots[s].groups[3].push_back(slots[s].triadkernel);
+    }
+
+    initializeArrays(dev.A, dev.B, dev.C, config.arraySize);
+
+    printf("Pipelined end-to-end execution with %llu chunks of %llu elements and %u buffer sets\n",
+           (unsigned long long) num_chunks, (unsigned long long) chunk_size, num_slots);
+    printf(HLINE);
+
+    std::vector<double> elapsed(config.ntimes), busy(config.ntimes);
+    std::vector<cl::Event> write_events(num_chunks * 3), kernel_events(num_chunks * 4),
+                           read_events(num_chunks * 3);
+    for (unsigned k=0; k<config.ntimes; k++) {
+        std::cout << "Execute iteration " << (k + 1) << " of " << config.ntimes << std::endl;
+        double t = mysecond();
+        for (size_t i=0; i<num_chunks; i++) {
+            StreamDevice<T>& slot = slots[i % num_slots];
+            size_t offset = i * chunk_size;
+            size_t length = MIN(chunk_size, config.arraySize - offset);
+            size_t length_bytes = sizeof(T) * length;
+
+            // wait until the previous chunk in this buffer set was read back
+            std::vector<cl::Event> slot_free;
+            if (i >= num_slots) {
+                slot_free.push_back(read_events[3 * (i - num_slots) + 2]);
+            }
+            write_queue.enqueueWriteBuffer(slot.Buffer_A, CL_FALSE, 0, length_bytes, dev.A + offset,
+                                           &slot_free, &write_events[3 * i]);
+            write_queue.enqueueWriteBuffer(slot.Buffer_B, CL_FALSE, 0, length_bytes, dev.B + offset,
+                                           NULL, &write_events[3 * i + 1]);
+            write_queue.enqueueWriteBuffer(slot.Buffer_C, CL_FALSE, 0, length_bytes, dev.C + offset,
+                                           NULL, &write_events[3 * i + 2]);
+            write_queue.flush();
+
+            setArraySize(slot, length);
+            std::vector<cl::Event> uploaded(1, write_events[3 * i + 2]);
+            compute_queue.enqueueTask(slot.copykernel, &uploaded, &kernel_events[4 * i]);
+            compute_queue.enqueueTask(slot.scalekernel, NULL, &kernel_events[4 * i + 1]);
+            compute_queue.enqueueTask(slot.addkernel, NULL, &kernel_events[4 * i + 2]);
+            compute_queue.enqueueTask(slot.triadkernel, NULL, &kernel_events[4 * i + 3]);
+            compute_queue.flush();
+
+            std::vector<cl::Event> computed(1, kernel_events[4 * i + 3]);
+            read_queue.enqueueReadBuffer(slot.Buffer_A, CL_FALSE, 0, length_bytes, dev.A + offset,
+                                         &computed, &read_events[3 * i]);
+            read_queue.enqueueReadBuffer(slot.Buffer_B, CL_FALSE, 0, length_bytes, dev.B + offset,
+                                         NULL, &read_events[3 * i + 1]);
+            read_queue.enqueueReadBuffer(slot.Buffer_C, CL_FALSE, 0, length_bytes, dev.C + offset,
+                                         NULL, &read_events[3 * i + 2]);
+            read_queue.flush();
+        }
+        err = write_queue.finish();
+        assert(err==CL_SUCCESS);
+        err = compute_queue.finish();
+        assert(err==CL_SUCCESS);
+        err = read_queue.finish();
+        assert(err==CL_SUCCESS);
+        elapsed[k] = mysecond() - t;
+
+        // sum of the execution times of all commands to calculate the overlap
+        busy[k] = 0.0;
+        std::vector<cl::Event>* all_events[3] = {&write_events, &kernel_events, &read_events};
+        for (int q=0; q<3; q++) {
+            for (size_t e=0; e<all_events[q]->size(); e++) {
+                cl::Event& ev = (*all_events[q])[e];
+                busy[k] += 1.0E-9 * (ev.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                                     - ev.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+            }
+        }
+    }
+
+    double pcie_bytes = 6 * sizeof(T) * (double) config.arraySize;
+    double kernel_bytes = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+    printf("Function    Best Rate MB/s  Avg time     Min time     Overlap\n");
+    printf("PCIe:       %12.1f  %11.6f  %11.6f  %9.2f\n",
+           1.0E-06 * pcie_bytes / minTime(elapsed), avgTime(elapsed), minTime(elapsed),
+           avgTime(busy) / avgTime(elapsed));
+    printf("Kernels:    %12.1f\n", 1.0E-06 * kernel_bytes / minTime(elapsed));
+    printf(HLINE);
+    printf("PCIe is the sustained rate of the uploads and downloads of all three arrays.\n");
+    printf("Kernels is the rate of all four kernels including the transfers.\n");
+    printf("Overlap is the sum of the execution times of all commands divided by the\n");
+    printf("elapsed time. A value of 1.0 means there is no overlap.\n");
+    printf(HLINE);
+    checkSTREAMresults(dev.A, dev.B, dev.C, config.arraySize, false);
+    printf(HLINE);
+}
+
+/*
+*  Measure the PCIe write and read of the three arrays with the given
+*  transfer strategy. The host arrays are filled with a pattern before
+*  the writes and cleared before the reads, so the data that was read back
+*  can be validated. Returns false if the strategy is not supported by
+*  the device.
+*-----------------------------------------------------------------------*/
+template<typename T>
+bool measureTransfers(StreamDevice<T>& dev, TransferStrategy strategy,
+                      std::vector<double>& write_times, std::vector<double>& read_times,
+                      size_t& errors)
+{
+    int err;
+    size_t buffer_size = sizeof(T) * config.arraySize;
+    T* host[3] = {dev.A, dev.B, dev.C};
+    cl::Buffer* device[3] = {&dev.Buffer_A, &dev.Buffer_B, &dev.Buffer_C};
+
+    // Additional buffers and host memory used by the strategies
+    std::vector<cl::Buffer> buffers(3);
+    std::vector<cl::Memory> migrate_objects;
+    T* staging[3] = {NULL, NULL, NULL};
+
+    // Unmap or free the staging memory that was allocated so far
+    auto release_staging = [&]() {
+        for (int i=0; i<3; i++) {
+            if (staging[i] == NULL) {
+                continue;
+            }
+            if (strategy == TRANSFER_PINNED) {
+                dev.queue.enqueueUnmapMemObject(buffers[i], staging[i]);
+            }
+#ifdef CL_VERSION_2_0
+            if (strategy == TRANSFER_SVM) {
+                clSVMFree(dev.context(), staging[i]);
+            }
+#endif
+        }
+        dev.queue.finish();
+    };
+
+    switch (strategy) {
+        case TRANSFER_PINNED:
+            // Pinned staging memory that is allocated and mapped by the runtime
+            for (int i=0; i<3; i++) {
+                buffers[i] = cl::Buffer(dev.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, buffer_size);
+                staging[i] = (T*) dev.queue.enqueueMapBuffer(buffers[i], CL_TRUE,
+                                    CL_MAP_READ | CL_MAP_WRITE, 0, buffer_size, NULL, NULL, &err);
+                assert(err==CL_SUCCESS);
+            }
+            break;
+        case TRANSFER_USE_HOST_PTR:
+            // Buffers that use the host arrays as backing store
+            for (int i=0; i<3; i++) {
+                buffers[i] = cl::Buffer(dev.context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, buffer_size, host[i]);
+                migrate_objects.push_back(buffers[i]);
+            }
+            break;
+        case TRANSFER_SVM:
+#ifdef CL_VERSION_2_0
+            {
+                cl_device_svm_capabilities svm_caps = 0;
+                clGetDeviceInfo(dev.device(), CL_DEVICE_SVM_CAPABILITIES, sizeof(svm_caps), &svm_caps, NULL);
+                if ((svm_caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER) == 0) {
+                    return false;
+                }
+                for (int i=0; i<3; i++) {
+                    staging[i] = (T*) clSVMAlloc(dev.context(), CL_MEM_READ_WRITE, buffer_size, 0);
+                    if (staging[i] == NULL) {
+                        release_staging();
+                        return false;
+                    }
+                }
+            }
+            break;
+#else
+            return false;
+#endif
+        default:
+            break;
+    }
+
+    for (unsigned k=0; k<config.ntimes; k++) {
+        for (int i=0; i<3; i++) {
+            for (size_t j=0; j<config.arraySize; j++) {
+                host[i][j] = (T) ((i + 1) * (j % 1024));
+            }
+            if (strategy == TRANSFER_PINNED) {
+                memcpy(staging[i], host[i], buffer_size);
+            }
+        }
+
+        write_times[k] = mysecond();
+        for (int i=0; i<3; i++) {
+            switch (strategy) {
+                case TRANSFER_READ_WRITE:
+                    dev.queue.enqueueWriteBuffer(*device[i], CL_FALSE, 0, buffer_size, host[i]);
+                    break;
+                case TRANSFER_PINNED:
+                    dev.queue.enqueueWriteBuffer(*device[i], CL_FALSE, 0, buffer_size, staging[i]);
+                    break;
+                case TRANSFER_MAP: {
+                    void* ptr = dev.queue.enqueueMapBuffer(*device[i], CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION,
+                                                           0, buffer_size, NULL, NULL, &err);
+                    assert(err==CL_SUCCESS);
+                    memcpy(ptr, host[i], buffer_size);
+                    dev.queue.enqueueUnmapMemObject(*device[i], ptr);
+                    break;
+                }
+#ifdef CL_VERSION_2_0
+                case TRANSFER_SVM:
+                    clEnqueueSVMMemcpy(dev.queue(), CL_FALSE, staging[i], host[i], buffer_size, 0, NULL, NULL);
+                    break;
+#endif
+                default:
+                    break;
+            }
+        }
+        if (strategy == TRANSFER_USE_HOST_PTR) {
+            dev.queue.enqueueMigrateMemObjects(migrate_objects, 0);
+        }
+        err = dev.queue.finish();
+        write_times[k] = mysecond() - write_times[k];
+        assert(err==CL_SUCCESS);
+
+        for (int i=0; i<3; i++) {
+            memset(host[i], 0, buffer_size);
+            if (strategy == TRANSFER_PINNED) {
+                memset(staging[i], 0, buffer_size);
+            }
+        }
+
+        read_times[k] = mysecond();
+        if (strategy == TRANSFER_USE_HOST_PTR) {
+            dev.queue.enqueueMigrateMemObjects(migrate_objects, CL_MIGRATE_MEM_OBJECT_HOST);
+        }
+        for (int i=0; i<3; i++) {
+            switch (strategy) {
+                case TRANSFER_READ_WRITE:
+                    dev.queue.enqueueReadBuffer(*device[i], CL_FALSE, 0, buffer_size, host[i]);
+                    break;
+                case TRANSFER_PINNED:
+                    dev.queue.enqueueReadBuffer(*device[i], CL_FALSE, 0, buffer_size, staging[i]);
+                    break;
+                case TRANSFER_MAP: {
+                    void* ptr = dev.queue.enqueueMapBuffer(*device[i], CL_TRUE, CL_MAP_READ,
+                                                           0, buffer_size, NULL, NULL, &err);
+                    assert(err==CL_SUCCESS);
+                    memcpy(host[i], ptr, buffer_size);
+                    dev.queue.enqueueUnmapMemObject(*device[i], ptr);
+                    break;
+                }
+#ifdef CL_VERSION_2_0
+                case TRANSFER_SVM:
+                    clEnqueueSVMMemcpy(dev.queue(), CL_FALSE, host[i], staging[i], buffer_size, 0, NULL, NULL);
+                    break;
+#endif
+                default:
+                    break;
+            }
+        }
+        err = dev.queue.finish();
+        read_times[k] = mysecond() - read_times[k];
+        assert(err==CL_SUCCESS);
+
+        if (strategy == TRANSFER_PINNED) {
+            for (int i=0; i<3; i++) {
+                memcpy(host[i], staging[i], buffer_size);
+            }
+        }
+    }
+
+    errors = 0;
+    for (int i=0; i<3; i++) {
+        for (size_t j=0; j<config.arraySize; j++) {
+            if (host[i][j] != (T) ((i + 1) * (j % 1024))) {
+                errors++;
+            }
+        }
+    }
+
+    release_staging();
+    return true;
+}
+
+/*
+*  Measure the PCIe transfers with all strategies selected in
+*  config.transferStrategies and print the results side by side.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runTransfers(StreamDevice<T>& dev)
+{
+    std::vector<double> write_times(config.ntimes), read_times(config.ntimes);
+    double transfer_bytes = 3 * sizeof(T) * (double) config.arraySize;
+
+    printf("PCIe transfers of the three arrays with different host memory strategies\n");
+    printf(HLINE);
+    printf("Strategy       Write MB/s   Read MB/s  Avg write    Avg read   Valid\n");
+    for (int s=0; s<NUM_TRANSFER_STRATEGIES; s++) {
+        if ((config.transferStrategies & (1 << s)) == 0) {
+            continue;
+        }
+        size_t errors = 0;
+        if (!measureTransfers(dev, (TransferStrategy) s, write_times, read_times, errors)) {
+            printf("%-12s   not supported by the device\n", transferNames[s]);
+            continue;
+        }
+        printf("%-12s %12.1f %11.1f %10.6f %11.6f %7s\n", transferNames[s],
+               1.0E-06 * transfer_bytes / minTime(write_times),
+               1.0E-06 * transfer_bytes / minTime(read_times),
+               avgTime(write_times), avgTime(read_times), errors == 0 ? "yes" : "no");
+    }
+    printf(HLINE);
+    printf("rw:      enqueueWriteBuffer/enqueueReadBuffer from the host arrays\n");
+    printf("pinned:  transfers from staging memory allocated with CL_MEM_ALLOC_HOST_PTR\n");
+    printf("hostptr: migration of buffers created with CL_MEM_USE_HOST_PTR\n");
+    printf("map:     enqueueMapBuffer and copy into the mapped memory\n");
+    printf("svm:     copy into coarse grained shared virtual memory\n");
+    printf(HLINE);
+}
+
+/*
+*  Measure single PCIe transfers to and from every buffer for transfer
+*  sizes from 64 bytes up to the buffer size, doubling the size in every
+*  step. Every transfer is blocking and timed with the profiling
+*  information of its event. The latency is the average time from QUEUED
+*  to END, the rate is calculated from the minimum time from START to END.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runPCIeSweep(StreamDevice<T>& dev)
+{
+    int err;
+    size_t buffer_size = sizeof(T) * config.arraySize;
+    const char* buffer_names[3] = {"A", "B", "C"};
+    cl::Buffer* device[3] = {&dev.Buffer_A, &dev.Buffer_B, &dev.Buffer_C};
+    char* host[3] = {(char*) dev.A, (char*) dev.B, (char*) dev.C};
+    std::vector<double> write_latency(config.ntimes), write_time(config.ntimes),
+                        read_latency(config.ntimes), read_time(config.ntimes);
+    cl::Event e;
+
+    printf("PCIe transfers of single buffers for sizes from 64 bytes to %llu bytes\n",
+           (unsigned long long) buffer_size);
+    printf(HLINE);
+    printf("%14s %6s %18s %12s %18s %12s\n", "Bytes", "Buffer", "Write latency (us)", "Write MB/s",
+           "Read latency (us)", "Read MB/s");
+
+    size_t transfer_size = 64;
+    while (true) {
+        for (int b=0; b<3; b++) {
+            for (unsigned k=0; k<config.ntimes; k++) {
+                err = dev.queue.enqueueWriteBuffer(*device[b], CL_TRUE, 0, transfer_size, host[b], NULL, &e);
+                assert(err==CL_SUCCESS);
+                write_latency[k] = 1.0E-9 * (e.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                                             - e.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>());
+                write_time[k] = 1.0E-9 * (e.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                                          - e.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+
+                err = dev.queue.enqueueReadBuffer(*device[b], CL_TRUE, 0, transfer_size, host[b], NULL, &e);
+                assert(err==CL_SUCCESS);
+                read_latency[k] = 1.0E-9 * (e.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                                            - e.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>());
+                read_time[k] = 1.0E-9 * (e.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                                         - e.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+            }
+            printf("%14llu %6s %18.2f %12.1f %18.2f %12.1f\n", (unsigned long long) transfer_size,
+                   buffer_names[b],
+                   1.0E6 * avgTime(write_latency), 1.0E-06 * transfer_size / minTime(write_time),
+                   1.0E6 * avgTime(read_latency), 1.0E-06 * transfer_size / minTime(read_time));
+        }
+        fflush(stdout);
+        if (transfer_size >= buffer_size) {
+            break;
+        }
+        transfer_size = MIN(2 * transfer_size, buffer_size);
+    }
+    printf(HLINE);
+}
+
+/*
+*  Bytes that the memory has to transfer for accesses with the given stride
+*  in elements. Accesses that are further apart than a burst need a burst
+*  of MEMORY_BURST_SIZE bytes each. A stride of 0 stands for random accesses.
+*-----------------------------------------------------------------------*/
+template<typename T>
+double rawBytes(size_t accesses, size_t stride)
+{
+    size_t distance = (stride == 0) ? MEMORY_BURST_SIZE : stride * sizeof(T);
+    return (double) accesses * MAX(MIN(distance, (size_t) MEMORY_BURST_SIZE), sizeof(T));
+}
+
+/*
+*  Execute the kernel ntimes and return the device times of all iterations.
+*/
+template<typename T>
+std::vector<double> timeKernel(StreamDevice<T>& dev, cl::Kernel& kernel)
+{
+    std::vector<double> times(config.ntimes);
+    cl::Event e;
+    for (unsigned k=0; k<config.ntimes; k++) {
+        int err = dev.queue.enqueueTask(kernel, NULL, &e);
+        assert(err==CL_SUCCESS);
+        err = e.wait();
+        assert(err==CL_SUCCESS);
+        times[k] = 1.0E-9 * (e.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                             - e.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+    }
+    return times;
+}
+
+/*
+*  Measure the kernels of stream_kernels_access.cl for the strides
+*  1, 2, 4, ... up to config.maxStride elements and for random indices.
+*  The strided kernels access every stride-th element of the arrays. The
+*  gather and scatter kernels read or write the elements in the order of an
+*  index array, where consecutive indices are stride elements apart.
+*  For every kernel the effective rate of the accessed elements and the raw
+*  rate of the bursts the memory has to transfer for them is reported.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runAccessSweep(StreamDevice<T>& dev)
+{
+    int err;
+    size_t buffer_size = sizeof(T) * config.arraySize;
+    T scalar = 3.0;
+    std::vector<cl_uint> idx(config.arraySize);
+    cl::Buffer Buffer_idx(dev.context, CL_MEM_READ_ONLY, sizeof(cl_uint) * config.arraySize);
+
+    cl::Kernel strided_copy(dev.program, STREAM_STRIDED_COPY_KERNEL, &err);
+    assert(err==CL_SUCCESS);
+    cl::Kernel strided_triad(dev.program, STREAM_STRIDED_TRIAD_KERNEL, &err);
+    assert(err==CL_SUCCESS);
+    cl::Kernel gather(dev.program, STREAM_GATHER_KERNEL, &err);
+    assert(err==CL_SUCCESS);
+    cl::Kernel scatter(dev.program, STREAM_SCATTER_KERNEL, &err);
+    assert(err==CL_SUCCESS);
+    strided_copy.setArg(0, dev.Buffer_A);
+    strided_copy.setArg(1, dev.Buffer_C);
+    strided_copy.setArg(3, (cl_uint) config.arraySize);
+    strided_triad.setArg(0, dev.Buffer_B);
+    strided_triad.setArg(1, dev.Buffer_A);
+    strided_triad.setArg(2, dev.Buffer_C);
+    strided_triad.setArg(3, scalar);
+    strided_triad.setArg(5, (cl_uint) config.arraySize);
+    gather.setArg(0, dev.Buffer_A);
+    gather.setArg(1, Buffer_idx);
+    gather.setArg(2, dev.Buffer_C);
+    scatter.setArg(0, dev.Buffer_A);
+    scatter.setArg(1, Buffer_idx);
+    scatter.setArg(2, dev.Buffer_C);
+
+    // Distinct values, so the validation detects elements from wrong indices.
+    // They are integers that are exact in the element type, for half up to 1024.
+    size_t value_range = sizeof(T) <= 2 ? 1024 : 1000000;
+    for (size_t j=0; j<config.arraySize; j++) {
+        dev.A[j] = (T) (j % value_range);
+        dev.B[j] = 2.0;
+    }
+    dev.queue.enqueueWriteBuffer(dev.Buffer_A, CL_TRUE, 0, buffer_size, dev.A);
+    dev.queue.enqueueWriteBuffer(dev.Buffer_B, CL_TRUE, 0, buffer_size, dev.B);
+
+    // The device rounds the product and the sum of the triad, which are not
+    // exact for half, so the relative error may be up to twice the epsilon
+    double epsilon = 2.0 * (double) std::numeric_limits<T>::epsilon();
+
+    printf("Strided and indexed accesses for strides from 1 to %u elements\n", config.maxStride);
+    printf("Rates in MB/s from the device time. eff: accessed elements, raw: transferred bursts of %d bytes\n",
+           MEMORY_BURST_SIZE);
+    printf(HLINE);
+    printf("%8s %10s %10s %10s %10s %10s %10s %10s %10s %6s\n", "Stride", "Copy eff", "Copy raw",
+           "Triad eff", "Triad raw", "Gather eff", "Gather raw", "Scatter eff", "Scatter raw", "Valid");
+
+    std::mt19937 generator(42);
+    for (size_t stride=1; ; stride*=2) {
+        // stride 0 after the sweep: random permutation for gather and scatter
+        bool random = stride > config.maxStride || stride > config.arraySize;
+        if (random) {
+            stride = 0;
+        }
+        size_t count = random ? config.arraySize : config.arraySize / stride;
+        size_t length = random ? config.arraySize : count * stride;
+        size_t errors = 0;
+
+        if (random) {
+            printf("%8s %10s %10s %10s %10s", "random", "-", "-", "-", "-");
+        }
+        else {
+            strided_copy.setArg(2, (cl_uint) stride);
+            strided_triad.setArg(4, (cl_uint) stride);
+            std::vector<double> copy_times = timeKernel(dev, strided_copy);
+            dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_TRUE, 0, buffer_size, dev.C);
+            for (size_t i=0; i<count; i++) {
+                errors += (dev.C[i * stride] != dev.A[i * stride]) ? 1 : 0;
+            }
+            std::vector<double> triad_times = timeKernel(dev, strided_triad);
+            dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_TRUE, 0, buffer_size, dev.C);
+            for (size_t i=0; i<count; i++) {
+                double expected = (double) dev.B[i * stride] + (double) scalar * (double) dev.A[i * stride];
+                errors += (fabs((double) dev.C[i * stride] - expected) > epsilon * fabs(expected)) ? 1 : 0;
+            }
+            printf("%8llu %10.1f %10.1f %10.1f %10.1f", (unsigned long long) stride,
+                   1.0E-06 * 2 * sizeof(T) * count / minTime(copy_times),
+                   1.0E-06 * 2 * rawBytes<T>(count, stride) / minTime(copy_times),
+                   1.0E-06 * 3 * sizeof(T) * count / minTime(triad_times),
+                   1.0E-06 * 3 * rawBytes<T>(count, stride) / minTime(triad_times));
+        }
+
+        // Consecutive indices are stride elements apart, so every block of
+        // length / stride indices walks once over the array
+        for (size_t i=0; i<length; i++) {
+            idx[i] = random ? i : (i % count) * stride + i / count;
+        }
+        if (random) {
+            std::shuffle(idx.begin(), idx.begin() + length, generator);
+        }
+        dev.queue.enqueueWriteBuffer(Buffer_idx, CL_TRUE, 0, sizeof(cl_uint) * length, idx.data());
+        gather.setArg(3, (cl_uint) length);
+        scatter.setArg(3, (cl_uint) length);
+
+        std::vector<double> gather_times = timeKernel(dev, gather);
+        dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_TRUE, 0, buffer_size, dev.C);
+        for (size_t i=0; i<length; i++) {
+            errors += (dev.C[i] != dev.A[idx[i]]) ? 1 : 0;
+        }
+        std::vector<double> scatter_times = timeKernel(dev, scatter);
+        dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_TRUE, 0, buffer_size, dev.C);
+        for (size_t i=0; i<length; i++) {
+            errors += (dev.C[idx[i]] != dev.A[i]) ? 1 : 0;
+        }
+
+        // The index array and the sequential side are read or written completely
+        double sequential_bytes = (double) length * (sizeof(T) + sizeof(cl_uint));
+        double effective_bytes = sequential_bytes + (double) length * sizeof(T);
+        double raw_bytes = sequential_bytes + rawBytes<T>(length, stride);
+        printf(" %10.1f %10.1f %11.1f %11.1f %6s\n",
+               1.0E-06 * effective_bytes / minTime(gather_times),
+               1.0E-06 * raw_bytes / minTime(gather_times),
+               1.0E-06 * effective_bytes / minTime(scatter_times),
+               1.0E-06 * raw_bytes / minTime(scatter_times),
+               errors == 0 ? "yes" : "no");
+        fflush(stdout);
+        if (random) {
+            break;
+        }
+    }
+    printf(HLINE);
+}
+
+/*
+*  Measure the read and write bandwidth separately with the fill kernel,
+*  that only writes C, the sum kernel, that only reads A and returns a
+*  single value, and the read_ratio and write_ratio kernels, that read
+*  READ_WRITE_RATIO elements of A for every element written to C and vice
+*  versa. For every kernel a row with the total rate and the rates of the
+*  reads and the writes is printed, followed by the statistics of the times.
+*  The rates are calculated from the device times.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runReadWrite(StreamDevice<T>& dev)
+{
+    int err;
+    size_t buffer_size = sizeof(T) * config.arraySize;
+    T value = 7.0;
+    T sum_result;
+    cl::Buffer Buffer_sum(dev.context, CL_MEM_WRITE_ONLY, sizeof(T));
+
+    cl::Kernel kernels[4];
+    const char* names[4] = {STREAM_FILL_KERNEL, STREAM_SUM_KERNEL,
+                            STREAM_READ_RATIO_KERNEL, STREAM_WRITE_RATIO_KERNEL};
+    for (int j=0; j<4; j++) {
+        kernels[j] = cl::Kernel(dev.program, names[j], &err);
+        assert(err==CL_SUCCESS);
+    }
+    kernels[0].setArg(0, dev.Buffer_C);
+    kernels[0].setArg(1, value);
+    kernels[1].setArg(0, dev.Buffer_A);
+    kernels[1].setArg(1, Buffer_sum);
+    for (int j=2; j<4; j++) {
+        kernels[j].setArg(0, dev.Buffer_A);
+        kernels[j].setArg(1, dev.Buffer_C);
+    }
+    kernels[0].setArg(2, (cl_uint) config.arraySize);
+    kernels[1].setArg(2, (cl_uint) config.arraySize);
+    kernels[2].setArg(2, (cl_uint) config.arraySize);
+    kernels[3].setArg(2, (cl_uint) config.arraySize);
+
+    // Small integers, so the sums are exact in all element types
+    for (size_t i=0; i<config.arraySize; i++) {
+        dev.A[i] = (T) (i % 4);
+    }
+    dev.queue.enqueueWriteBuffer(dev.Buffer_A, CL_TRUE, 0, buffer_size, dev.A);
+
+    // The ratio kernels split the arrays into READ_WRITE_RATIO parts of full vectors
+    size_t count = config.arraySize / (READ_WRITE_RATIO * config.vectorWidth) * config.vectorWidth;
+    double element_bytes = sizeof(T);
+    double read_bytes[4] = {0.0, element_bytes * config.arraySize,
+                            element_bytes * count * READ_WRITE_RATIO, element_bytes * count};
+    double write_bytes[4] = {element_bytes * config.arraySize, element_bytes,
+                             element_bytes * count, element_bytes * count * READ_WRITE_RATIO};
+    char ratio_labels[2][32];
+    snprintf(ratio_labels[0], sizeof(ratio_labels[0]), "Read %d:1:", READ_WRITE_RATIO);
+    snprintf(ratio_labels[1], sizeof(ratio_labels[1]), "Write 1:%d:", READ_WRITE_RATIO);
+    std::string labels[4] = {"Fill:", "Sum:", ratio_labels[0], ratio_labels[1]};
+    for (int j=0; j<4; j++) {
+        labels[j].resize(MAX(labels[j].size() + 1, (size_t) 12), ' ');
+    }
+
+    std::vector<std::vector<double> > times(4);
+    size_t errors[4] = {0, 0, 0, 0};
+    bool sum_checked = true;
+    for (int j=0; j<4; j++) {
+        times[j] = timeKernel(dev, kernels[j]);
+        switch (j) {
+            case 0:
+                dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_TRUE, 0, buffer_size, dev.C);
+                for (size_t i=0; i<config.arraySize; i++) {
+                    errors[j] += ((double) dev.C[i] != (double) value) ? 1 : 0;
+                }
+                break;
+            case 1: {
+                dev.queue.enqueueReadBuffer(Buffer_sum, CL_TRUE, 0, sizeof(T), &sum_result);
+                double expected = 0.0;
+                for (size_t i=0; i<config.arraySize; i++) {
+                    expected += (double) dev.A[i];
+                }
+                double epsilon = std::numeric_limits<T>::is_integer ? 0.0
+                                 : (sizeof(T) <= 2 ? 1.e-2 : 1.e-6);
+                sum_checked = expected <= (double) std::numeric_limits<T>::max();
+                if (sum_checked && fabs((double) sum_result - expected) > epsilon * expected) {
+                    printf("Sum: expected %f but got %f\n", expected, (double) sum_result);
+                    errors[j]++;
+                }
+                break;
+            }
+            case 2:
+                dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_TRUE, 0, buffer_size, dev.C);
+                for (size_t i=0; i<count; i++) {
+                    double expected = 0.0;
+                    for (size_t r=0; r<READ_WRITE_RATIO; r++) {
+                        expected += (double) dev.A[r * count + i];
+                    }
+                    errors[j] += ((double) dev.C[i] != expected) ? 1 : 0;
+                }
+                break;
+            case 3:
+                dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_TRUE, 0, buffer_size, dev.C);
+                for (size_t i=0; i<count * READ_WRITE_RATIO; i++) {
+                    errors[j] += ((double) dev.C[i] != (double) dev.A[i % count]) ? 1 : 0;
+                }
+                break;
+        }
+    }
+
+    printf("Read and write bandwidth with the device times\n");
+    printf(HLINE);
+    printf("Function    Best Rate MB/s  Read MB/s  Write MB/s  Avg time     Min time     Max time     Valid\n");
+    for (int j=0; j<4; j++) {
+        double min_time = minTime(times[j]);
+        printf("%s%12.1f  %9.1f  %10.1f  %11.6f  %11.6f  %11.6f  %5s\n", labels[j].c_str(),
+               1.0E-06 * (read_bytes[j] + write_bytes[j]) / min_time,
+               1.0E-06 * read_bytes[j] / min_time,
+               1.0E-06 * write_bytes[j] / min_time,
+               avgTime(times[j]), min_time, maxTime(times[j]),
+               errors[j] == 0 ? "yes" : "no");
+    }
+    printf(HLINE);
+    printf("Statistics of the times in seconds and the 95%% confidence interval of the mean rate:\n");
+    printf("Function    Samples  Median       Stddev       p95          p99          Mean rate CI MB/s\n");
+    for (int j=0; j<4; j++) {
+        printStatistics(labels[j], times[j], read_bytes[j] + write_bytes[j]);
+    }
+    printf(HLINE);
+    if (!sum_checked) {
+        printf("The sum exceeds the range of %s and was not validated\n", StreamTypeName<T>::kernel());
+    }
+    if (errors[0] + errors[1] + errors[2] + errors[3] == 0) {
+        printf("Solution Validates\n");
+    }
+    else {
+        printf("Failed Validation of the read and write kernels\n");
+    }
+    printf(HLINE);
+}
+
+/*
+*  Print a row with the statistics of the given latencies in microseconds.
+*-----------------------------------------------------------------------*/
+void printLatencyRow(const char* label, const std::vector<double>& times)
+{
+    TimeStatistics stats = timeStatistics(times);
+    printf("%-24s %10.2f %10.2f %10.2f %10.2f %10.2f\n", label, 1.0E6 * stats.avg, 1.0E6 * stats.min,
+           1.0E6 * stats.median, 1.0E6 * stats.p99, 1.0E6 * stats.max);
+}
+
+/*
+*  Measure the cost of kernel launches independent of the memory bandwidth.
+*  First the empty kernel is launched config.launches times and the host
+*  waits for every launch. The round trip is measured on the host, the time
+*  from the enqueue to the start of the kernel and the kernel time with the
+*  event profiling. If the bitstream has no empty kernel, copy with an array
+*  size of 0 is used instead.
+*  Then the copy kernel is launched config.launches times back-to-back for
+*  tiny array sizes starting at twice the vector width, which is the smallest
+*  size the vectorized kernels process, once with a wait after every launch and once with all
+*  launches enqueued before a single finish. For the batched launches also
+*  the idle time of the device between two kernels is calculated from the
+*  profiling information.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runLaunchLatency(StreamDevice<T>& dev)
+{
+    int err;
+    cl::Kernel empty(dev.program, STREAM_EMPTY_KERNEL, &err);
+    if (err != CL_SUCCESS) {
+        printf("Kernel %s not found, copy with 0 elements is used instead\n", STREAM_EMPTY_KERNEL);
+        setArraySize(dev, 0);
+        empty = dev.copykernel;
+    }
+
+    std::vector<double> round_trip(config.launches);
+    std::vector<double> to_start(config.launches);
+    std::vector<double> kernel_time(config.launches);
+    for (unsigned k=0; k<config.launches; k++) {
+        cl::Event e;
+        double t = mysecond();
+        err = dev.queue.enqueueTask(empty, NULL, &e);
+        assert(err==CL_SUCCESS);
+        err = e.wait();
+        round_trip[k] = mysecond() - t;
+        assert(err==CL_SUCCESS);
+        to_start[k] = 1.0E-9 * (e.getProfilingInfo<CL_PROFILING_COMMAND_START>()
+                                - e.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>());
+        kernel_time[k] = 1.0E-9 * (e.getProfilingInfo<CL_PROFILING_COMMAND_END>()
+                                   - e.getProfilingInfo<CL_PROFILING_COMMAND_START>());
+    }
+
+    printf("Launch latency of %u launches of the empty kernel in microseconds\n", config.launches);
+    printf(HLINE);
+    printf("%-24s %10s %10s %10s %10s %10s\n", "", "Avg", "Min", "Median", "p99", "Max");
+    printLatencyRow("Round trip (host)", round_trip);
+    printLatencyRow("Enqueue -> Start", to_start);
+    printLatencyRow("Start -> End", kernel_time);
+    printf(HLINE);
+
+    printf("Back-to-back launches of copy, %u launches per size\n", config.launches);
+    printf("Times per launch in microseconds and launches per second.\n");
+    printf("Wait: wait for every launch, Batch: single finish, Gap: device idle time between batched kernels\n");
+    printf(HLINE);
+    printf("%10s %10s %10s %10s %12s %12s %10s %8s\n", "Elements", "Bytes", "Wait", "Batch",
+           "Wait/s", "Batch/s", "Gap", "Speedup");
+    std::vector<cl::Event> events(config.launches);
+    size_t max_size = MIN((size_t) LAUNCH_MAX_SIZE, config.arraySize);
+    for (size_t size=2 * config.vectorWidth; size<=max_size; size*=8) {
+        setArraySize(dev, size);
+
+        double wait_time = mysecond();
+        for (unsigned k=0; k<config.launches; k++) {
+            err = dev.queue.enqueueTask(dev.copykernel, NULL, &events[k]);
+            assert(err==CL_SUCCESS);
+            err = events[k].wait();
+            assert(err==CL_SUCCESS);
+        }
+        wait_time = (mysecond() - wait_time) / config.launches;
+
+        double batch_time = mysecond();
+        for (unsigned k=0; k<config.launches; k++) {
+            err = dev.queue.enqueueTask(dev.copykernel, NULL, &events[k]);
+            assert(err==CL_SUCCESS);
+        }
+        err = dev.queue.finish();
+        assert(err==CL_SUCCESS);
+        batch_time = (mysecond() - batch_time) / config.launches;
+
+        // idle time of the device between the end of a kernel and the start of the next one
+        double gap = 0.0;
+        for (unsigned k=1; k<config.launches; k++) {
+            gap += 1.0E-9 * ((double) events[k].getProfilingInfo<CL_PROFILING_COMMAND_START>()
+                             - (double) events[k - 1].getProfilingInfo<CL_PROFILING_COMMAND_END>());
+        }
+        gap /= config.launches - 1;
+
+        printf("%10llu %10llu %10.2f %10.2f %12.0f %12.0f %10.2f %8.2f\n", (unsigned long long) size,
+               (unsigned long long) (2 * sizeof(T) * size), 1.0E6 * wait_time, 1.0E6 * batch_time,
+               1.0 / wait_time, 1.0 / batch_time, 1.0E6 * gap, wait_time / batch_time);
+        fflush(stdout);
+    }
+    printf(HLINE);
+    setArraySize(dev, config.arraySize);
+}
+
+/*
+*  Compare the isolated execution of the kernels with a chained execution
+*  without host synchronization. First config.ntimes iterations are executed
+*  like in the default mode, where the host waits for every kernel. Then
+*  copy, scale, add and triad of config.ntimes iterations are enqueued at
+*  once. Every kernel waits for the events of the previous kernel, so the
+*  chain also works with the concurrent kernels of a channel group, and the
+*  host only waits for the end of the last kernel.
+*  The sustained rate of the chain is the data of all kernels divided by the
+*  host time of the whole chain. The idle time of the device is the part of
+*  the chain where no kernel was executed according to the profiling.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runChained(StreamDevice<T>& dev)
+{
+    int err;
+    size_t buffer_size = sizeof(T) * config.arraySize;
+    size_t offset_bytes = sizeof(T) * dev.offset;
+    StreamTimings isolated(config.ntimes);
+    StreamTimings chained(config.ntimes);
+    double iteration_bytes = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+
+    executeIterations(dev, config.arraySize, isolated, false, NULL);
+
+    initializeArrays(dev.A, dev.B, dev.C, config.arraySize);
+    dev.queue.enqueueWriteBuffer(dev.Buffer_A, CL_FALSE, offset_bytes, buffer_size, dev.A);
+    dev.queue.enqueueWriteBuffer(dev.Buffer_B, CL_FALSE, offset_bytes, buffer_size, dev.B);
+    dev.queue.enqueueWriteBuffer(dev.Buffer_C, CL_FALSE, offset_bytes, buffer_size, dev.C);
+    err = dev.queue.finish();
+    assert(err==CL_SUCCESS);
+
+    std::vector<std::vector<cl::Event> > events(4 * config.ntimes);
+    double chain_time = mysecond();
+    for (unsigned k=0; k<config.ntimes; k++) {
+        for (int j=0; j<4; j++) {
+            unsigned i = 4 * k + j;
+            enqueueKernelGroup(dev, dev.groups[j], (i == 0) ? NULL : &events[i - 1], events[i]);
+        }
+    }
+    err = cl::Event::waitForEvents(events.back());
+    chain_time = mysecond() - chain_time;
+    assert(err==CL_SUCCESS);
+
+    double busy_time = 0.0;
+    for (unsigned k=0; k<config.ntimes; k++) {
+        for (int j=0; j<4; j++) {
+            recordProfiling(chained, j, k, events[4 * k + j]);
+            busy_time += chained.device[j][k];
+        }
+    }
+    cl_ulong chain_start = events.front().front().getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    cl_ulong chain_end = events.back().back().getProfilingInfo<CL_PROFILING_COMMAND_END>();
+    for (size_t i=0; i<events.front().size(); i++) {
+        chain_start = MIN(chain_start, events.front()[i].getProfilingInfo<CL_PROFILING_COMMAND_START>());
+        chain_end = MAX(chain_end, events.back()[i].getProfilingInfo<CL_PROFILING_COMMAND_END>());
+    }
+    double device_span = 1.0E-9 * (chain_end - chain_start);
+
+    // The isolated sequence is the time of the four kernels with a host wait after each of them
+    double isolated_time = 0.0;
+    for (int j=0; j<4; j++) {
+        isolated_time += avgTime(isolated.wall[j]);
+    }
+
+    printf("Isolated and chained execution of %u iterations of copy, scale, add and triad\n", config.ntimes);
+    printf(HLINE);
+    printf("Function    Isolated Device MB/s  Isolated E2E MB/s  Chained Device MB/s\n");
+    for (int j=0; j<4; j++) {
+        printf("%s%20.1f  %17.1f  %19.1f\n", label[j].c_str(),
+               1.0E-06 * bytes[j] / minTime(isolated.device[j]),
+               1.0E-06 * bytes[j] / minTime(isolated.wall[j]),
+               1.0E-06 * bytes[j] / minTime(chained.device[j]));
+    }
+    printf(HLINE);
+    printf("Avg time per iteration of the four kernels:\n");
+    printf("  Isolated with host waits:  %11.6f s  %10.1f MB/s\n", isolated_time,
+           1.0E-06 * iteration_bytes / isolated_time);
+    printf("  Chained without host sync: %11.6f s  %10.1f MB/s sustained\n", chain_time / config.ntimes,
+           1.0E-06 * iteration_bytes * config.ntimes / chain_time);
+    printf("  Speedup of the chain:      %11.2f\n", isolated_time * config.ntimes / chain_time);
+    printf("Device idle time between the chained kernels: %.1f%% of %.6f s\n",
+           100.0 * MAX(device_span - busy_time, 0.0) / device_span, device_span);
+    printf(HLINE);
+
+    dev.queue.enqueueReadBuffer(dev.Buffer_A, CL_FALSE, offset_bytes, buffer_size, dev.A);
+    dev.queue.enqueueReadBuffer(dev.Buffer_B, CL_FALSE, offset_bytes, buffer_size, dev.B);
+    dev.queue.enqueueReadBuffer(dev.Buffer_C, CL_FALSE, offset_bytes, buffer_size, dev.C);
+    err = dev.queue.finish();
+    assert(err==CL_SUCCESS);
+    checkSTREAMresults(dev.A, dev.B, dev.C, config.arraySize, false);
+    printf(HLINE);
+}
+
+/*
+*  Measure the latency of the global memory like lat_mem_rd with the
+*  pointer chasing kernel of stream_kernels_access.cl. The chain visits the
+*  nodes of the working set in a random cyclic order. The nodes are
+*  MEMORY_BURST_SIZE bytes apart, so every load needs its own burst.
+*  The working set grows by a factor of 4 from 4 KiB up to the size of an
+*  array. The chain is placed on every bank of config.banks or interleaved.
+*  The kernel is executed config.ntimes times with LATENCY_LOADS loads and
+*  the distribution of the time per load is given over these executions.
+*  The device time of a launch without loads is subtracted.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runMemoryLatency(StreamDevice<T>& dev)
+{
+    int err;
+    const size_t stride = MAX((size_t) MEMORY_BURST_SIZE / sizeof(cl_uint), (size_t) 1);
+    // the chain uses 32 bit indices
+    size_t max_bytes = MIN(sizeof(T) * config.arraySize, (size_t) UINT_MAX);
+    size_t max_entries = max_bytes / sizeof(cl_uint);
+    std::vector<cl_uint> next(max_entries);
+    cl_uint last;
+
+    if (max_bytes < 4096) {
+        std::cerr << "The arrays have to be at least 4 KiB for the latency measurement!" << std::endl;
+        return;
+    }
+    cl::Kernel chase(dev.program, STREAM_POINTER_CHASE_KERNEL, &err);
+    assert(err==CL_SUCCESS);
+    cl::Buffer Buffer_result(dev.context, CL_MEM_WRITE_ONLY, sizeof(cl_uint));
+    chase.setArg(1, Buffer_result);
+
+    // Distinct banks of the arrays, or the interleaved placement
+    std::vector<unsigned> banks;
+    for (int i=0; i<3; i++) {
+        if (std::find(banks.begin(), banks.end(), config.banks[i]) == banks.end()) {
+            banks.push_back(config.banks[i]);
+        }
+    }
+    std::vector<cl::Buffer> buffers;
+    for (size_t b=0; b<banks.size(); b++) {
+        buffers.push_back(cl::Buffer(dev.context, CL_MEM_READ_ONLY | bankFlag(banks[b]),
+                                     sizeof(cl_uint) * max_entries));
+    }
+
+    // device time of a launch without loads
+    chase.setArg(0, buffers.front());
+    chase.setArg(2, (cl_uint) 0);
+    chase.setArg(3, (cl_uint) 0);
+    double overhead = minTime(timeKernel(dev, chase));
+
+    printf("Latency of dependent loads with %d loads per launch, nodes are %d bytes apart\n",
+           LATENCY_LOADS, MEMORY_BURST_SIZE);
+    printf("Times in ns per load without the launch overhead of %.2f us\n", 1.0E6 * overhead);
+    printf(HLINE);
+    printf("%12s %12s %8s %8s %8s %8s %8s %8s %6s\n", "Working set", "Bank", "Avg", "Min",
+           "Median", "p95", "p99", "Max", "Valid");
+
+    std::mt19937 generator(42);
+    for (size_t bytes_used=4096; bytes_used<=max_bytes; bytes_used*=4) {
+        size_t nodes = MAX(bytes_used / (stride * sizeof(cl_uint)), (size_t) 1);
+
+        // random cycle over all nodes (Sattolo's algorithm)
+        std::vector<cl_uint> order(nodes);
+        for (size_t i=0; i<nodes; i++) {
+            order[i] = i;
+        }
+        for (size_t i=nodes - 1; i>0; i--) {
+            std::uniform_int_distribution<size_t> pick(0, i - 1);
+            std::swap(order[i], order[pick(generator)]);
+        }
+        for (size_t i=0; i<nodes; i++) {
+            next[order[i] * stride] = order[(i + 1) % nodes] * stride;
+        }
+        cl_uint expected = 0;
+        for (unsigned i=0; i<LATENCY_LOADS; i++) {
+            expected = next[expected];
+        }
+
+        for (size_t b=0; b<banks.size(); b++) {
+            err = dev.queue.enqueueWriteBuffer(buffers[b], CL_TRUE, 0, sizeof(cl_uint) * nodes * stride, next.data());
+            assert(err==CL_SUCCESS);
+            chase.setArg(0, buffers[b]);
+            chase.setArg(3, (cl_uint) LATENCY_LOADS);
+            std::vector<double> times = timeKernel(dev, chase);
+            for (size_t k=0; k<times.size(); k++) {
+                times[k] = MAX(times[k] - overhead, 0.0) / LATENCY_LOADS;
+            }
+            err = dev.queue.enqueueReadBuffer(Buffer_result, CL_TRUE, 0, sizeof(cl_uint), &last);
+            assert(err==CL_SUCCESS);
+
+            TimeStatistics stats = timeStatistics(times);
+            printf("%10.0f K %12s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %6s\n", bytes_used / 1024.0,
+                   banks[b] == 0 ? "interleaved" : std::to_string(banks[b]).c_str(),
+                   1.0E9 * stats.avg, 1.0E9 * stats.min, 1.0E9 * stats.median,
+                   1.0E9 * stats.p95, 1.0E9 * stats.p99, 1.0E9 * stats.max,
+                   last == expected ? "yes" : "no");
+            fflush(stdout);
+        }
+    }
+    printf(HLINE);
+}
+
+/*
+*  Largest element offset of the offset sweep, one burst of the memory
+*  interface or UNROLL_COUNT elements, whichever is larger.
+*-----------------------------------------------------------------------*/
+template<typename T>
+size_t maxSweepOffset()
+{
+    size_t max_offset = MAX((size_t) MEMORY_BURST_SIZE / sizeof(T), (size_t) 1);
+#ifdef UNROLL_COUNT
+    max_offset = MAX(max_offset, (size_t) UNROLL_COUNT);
+#endif
+    return max_offset;
+}
+
+/*
+*  Execute the benchmark with the arrays starting at every element offset
+*  from 0 up to maxSweepOffset(). Arrays that do not start at the
+*  beginning of a burst need an additional burst per access of the load
+*  store units. The kernels without vectors are required, since the
+*  vector kernels only support aligned offsets. The buffers are created
+*  once for the largest offset and the rates are compared to the aligned
+*  arrays at offset 0.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runOffsetSweep(StreamDevice<T>& dev)
+{
+    StreamTimings times(config.ntimes);
+    size_t used_offset = config.offset;
+    size_t max_offset = maxSweepOffset<T>();
+    config.offset = max_offset;
+    createBuffers(dev);
+
+    printf("Offsets from 0 to %llu elements, bursts of %d bytes\n", (unsigned long long) max_offset,
+           MEMORY_BURST_SIZE);
+    printf("Device rates in MB/s, relative rate to offset 0 averaged over the kernels\n");
+    printf(HLINE);
+    printf("%8s %8s %8s %10s %10s %10s %10s %9s %6s\n", "Offset", "Bytes", "Aligned", "Copy", "Scale",
+           "Add", "Triad", "Relative", "Valid");
+    double reference[4];
+    for (size_t offset=0; offset<=max_offset; offset++) {
+        dev.offset = offset;
+        setArraySize(dev, config.arraySize);
+        initializeArrays(dev.A, dev.B, dev.C, config.arraySize);
+        executeIterations(dev, config.arraySize, times, false, NULL);
+        bool valid = checkSTREAMresults(dev.A, dev.B, dev.C, config.arraySize, true) == 0;
+
+        size_t offset_bytes = sizeof(T) * offset;
+        printf("%8llu %8llu %8s", (unsigned long long) offset, (unsigned long long) offset_bytes,
+               offset_bytes % MEMORY_BURST_SIZE == 0 ? "yes" : "no");
+        double relative = 0.0;
+        for (int j=0; j<4; j++) {
+            double rate = 1.0E-06 * bytes[j] / minTime(times.device[j]);
+            if (offset == 0) {
+                reference[j] = rate;
+            }
+            relative += 0.25 * rate / reference[j];
+            printf(" %10.1f", rate);
+        }
+        printf(" %8.1f%% %6s\n", 100.0 * relative, valid ? "yes" : "no");
+        fflush(stdout);
+    }
+    printf(HLINE);
+
+    config.offset = used_offset;
+    dev.offset = used_offset;
+    setArraySize(dev, config.arraySize);
+}
+
+/*
+*  Execute the benchmark for all placements of the arrays A, B and C on the
+*  config.numBanks memory banks, including placements with several arrays
+*  on the same bank. The kernels have to be compiled with
+*  -no-interleaving=default. The buffers are recreated for every placement
+*  and the placements are ranked by the device rate of every kernel.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runBankExploration(StreamDevice<T>& dev)
+{
+    StreamTimings times(config.ntimes);
+    unsigned num_placements = config.numBanks * config.numBanks * config.numBanks;
+    std::vector<std::vector<unsigned> > placements;
+    std::vector<std::vector<double> > rates(4);
+    std::vector<bool> valid;
+    unsigned used_banks[3] = {config.banks[0], config.banks[1], config.banks[2]};
+
+    printf("Exploration of %u placements of the arrays A, B and C on %u banks\n",
+           num_placements, config.numBanks);
+    printf(HLINE);
+    printf("Device rates in MB/s\n");
+    printf("%-8s %10s %10s %10s %10s %10s %10s %6s\n", "A,B,C", "Copy", "Scale", "Add", "Triad",
+           "PCI Write", "PCI Read", "Valid");
+    for (unsigned p=0; p<num_placements; p++) {
+        config.banks[0] = p / (config.numBanks * config.numBanks) + 1;
+        config.banks[1] = (p / config.numBanks) % config.numBanks + 1;
+        config.banks[2] = p % config.numBanks + 1;
+        placements.push_back(std::vector<unsigned>(config.banks, config.banks + 3));
+
+        createBuffers(dev);
+        initializeArrays(dev.A, dev.B, dev.C, config.arraySize);
+        executeIterations(dev, config.arraySize, times, false, NULL);
+        valid.push_back(checkSTREAMresults(dev.A, dev.B, dev.C, config.arraySize, true) == 0);
+
+        printf("%-8s", placementName().c_str());
+        for (int j=0; j<6; j++) {
+            double rate = 1.0E-06 * bytes[j] / minTime(times.device[j]);
+            if (j < 4) {
+                rates[j].push_back(rate);
+            }
+            printf(" %10.1f", rate);
+        }
+        printf(" %6s\n", valid.back() ? "yes" : "no");
+        fflush(stdout);
+    }
+    printf(HLINE);
+
+    // Rank the valid placements by the rate of every kernel
+    const unsigned num_ranked = MIN(5u, num_placements);
+    printf("Best %u placements (A,B,C) per kernel:\n", num_ranked);
+    for (int j=0; j<4; j++) {
+        std::vector<unsigned> order;
+        for (unsigned p=0; p<num_placements; p++) {
+            if (valid[p]) {
+                order.push_back(p);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&rates, j](unsigned a, unsigned b) {
+            return rates[j][a] > rates[j][b];
+        });
+        printf("%s", label[j].c_str());
+        for (unsigned r=0; r<MIN(num_ranked, (unsigned) order.size()); r++) {
+            const std::vector<unsigned>& banks = placements[order[r]];
+            printf(" %u,%u,%u (%.1f)", banks[0], banks[1], banks[2], rates[j][order[r]]);
+        }
+        printf("\n");
+    }
+    printf(HLINE);
+
+    for (int i=0; i<3; i++) {
+        config.banks[i] = used_banks[i];
+    }
+}
+
+/*
+*  Split the arrays of dev into partitions for n compute units. Every
+*  partition gets its own buffers, queue and kernel objects and the host
+*  arrays point into the arrays of dev. The partitions are aligned to
+*  64 bytes and to twice the vector width, which copy and scale of
+*  stream_kernels_vec.cl process per iteration. If the arrays are placed on specific
+*  banks, the buffers of partition p are placed on bank p % config.numBanks + 1.
+*  The number of elements of every partition is returned in lengths.
+*-----------------------------------------------------------------------*/
+template<typename T>
+std::vector<StreamDevice<T> > createPartitions(StreamDevice<T>& dev, unsigned n, std::vector<size_t>& lengths)
+{
+    const char* kernel_names[4] = {STREAM_COPY_KERNEL, STREAM_SCALE_KERNEL,
+                                   STREAM_ADD_KERNEL, STREAM_TRIAD_KERNEL};
+    T scalar = 3.0;
+    size_t align = 2 * config.vectorWidth;
+    while (align % (64 / sizeof(T)) != 0) {
+        align += 2 * config.vectorWidth;
+    }
+    size_t part_size = ((config.arraySize + n - 1) / n + align - 1) / align * align;
+    std::vector<StreamDevice<T> > parts;
+    lengths.clear();
+    for (size_t base=0; base<config.arraySize; base += part_size) {
+        size_t length = MIN(part_size, config.arraySize - base);
+        size_t buffer_size = sizeof(T) * length;
+        cl_mem_flags flags = CL_MEM_READ_WRITE |
+                             (interleavedPlacement() ? 0 : bankFlag(parts.size() % config.numBanks + 1));
+        StreamDevice<T> part;
+        part.device = dev.device;
+        part.context = dev.context;
+        part.program = dev.program;
+        part.queue = cl::CommandQueue(dev.context, dev.device, CL_QUEUE_PROFILING_ENABLE);
+        part.groupQueues.push_back(part.queue);
+        part.A = dev.A + base;
+        part.B = dev.B + base;
+        part.C = dev.C + base;
+        part.Buffer_A = cl::Buffer(dev.context, flags, buffer_size);
+        part.Buffer_B = cl::Buffer(dev.context, flags, buffer_size);
+        part.Buffer_C = cl::Buffer(dev.context, flags, buffer_size);
+        part.offset = 0;
+        for (int j=0; j<4; j++) {
+            part.groups[j] = createKernelGroup(part.program, kernel_names[j]);
+            setGroupSize(part.groups[j], j, length);
+            setGroupOffset(part.groups[j], j, 0);
+        }
+        setGroupBuffers(part.groups[0], 0, part.Buffer_A, part.Buffer_A, part.Buffer_C);
+        setGroupBuffers(part.groups[1], 1, part.Buffer_C, part.Buffer_C, part.Buffer_B);
+        setGroupBuffers(part.groups[2], 2, part.Buffer_A, part.Buffer_B, part.Buffer_C);
+        setGroupBuffers(part.groups[3], 3, part.Buffer_B, part.Buffer_C, part.Buffer_A);
+        setGroupScalar(part.groups[1], 1, scalar);
+        setGroupScalar(part.groups[3], 3, scalar);
+        parts.push_back(part);
+        lengths.push_back(length);
+    }
+    return parts;
+}
+
+/*
+*  Execute a single iteration on all partitions and store the times as
+*  iteration k. The transfers and kernels of all partitions are enqueued
+*  before any of the queues is flushed, so they are executed concurrently.
+*  The device time is measured from the first START to the last END.
+*  Returns true if the kernels of all partitions overlapped in time.
+*-----------------------------------------------------------------------*/
+template<typename T>
+bool executePartitioned(std::vector<StreamDevice<T> >& parts, const std::vector<size_t>& lengths,
+                        StreamTimings& times, unsigned k)
+{
+    int err;
+    bool parallel = true;
+    std::vector<cl::Event> transfers(3 * parts.size());
+    std::vector<cl::Event> events(parts.size());
+
+    times.wall[4][k] = mysecond();
+    for (size_t p=0; p<parts.size(); p++) {
+        size_t buffer_size = sizeof(T) * lengths[p];
+        parts[p].queue.enqueueWriteBuffer(parts[p].Buffer_A, CL_FALSE, 0, buffer_size, parts[p].A, NULL, &transfers[3 * p]);
+        parts[p].queue.enqueueWriteBuffer(parts[p].Buffer_B, CL_FALSE, 0, buffer_size, parts[p].B, NULL, &transfers[3 * p + 1]);
+        parts[p].queue.enqueueWriteBuffer(parts[p].Buffer_C, CL_FALSE, 0, buffer_size, parts[p].C, NULL, &transfers[3 * p + 2]);
+    }
+    for (size_t p=0; p<parts.size(); p++) {
+        parts[p].queue.flush();
+    }
+    err = cl::Event::waitForEvents(transfers);
+    times.wall[4][k] = mysecond() - times.wall[4][k];
+    recordProfiling(times, 4, k, transfers);
+    assert(err==CL_SUCCESS);
+
+    for (int j=0; j<4; j++) {
+        times.wall[j][k] = mysecond();
+        for (size_t p=0; p<parts.size(); p++) {
+            err = parts[p].queue.enqueueTask(parts[p].groups[j].front(), NULL, &events[p]);
+            assert(err==CL_SUCCESS);
+        }
+        for (size_t p=0; p<parts.size(); p++) {
+            parts[p].queue.flush();
+        }
+        err = cl::Event::waitForEvents(events);
+        times.wall[j][k] = mysecond() - times.wall[j][k];
+        recordProfiling(times, j, k, events);
+        assert(err==CL_SUCCESS);
+        parallel = parallel && eventsOverlap(events);
+    }
+
+    times.wall[5][k] = mysecond();
+    for (size_t p=0; p<parts.size(); p++) {
+        size_t buffer_size = sizeof(T) * lengths[p];
+        parts[p].queue.enqueueReadBuffer(parts[p].Buffer_A, CL_FALSE, 0, buffer_size, parts[p].A, NULL, &transfers[3 * p]);
+        parts[p].queue.enqueueReadBuffer(parts[p].Buffer_B, CL_FALSE, 0, buffer_size, parts[p].B, NULL, &transfers[3 * p + 1]);
+        parts[p].queue.enqueueReadBuffer(parts[p].Buffer_C, CL_FALSE, 0, buffer_size, parts[p].C, NULL, &transfers[3 * p + 2]);
+    }
+    for (size_t p=0; p<parts.size(); p++) {
+        parts[p].queue.flush();
+    }
+    err = cl::Event::waitForEvents(transfers);
+    times.wall[5][k] = mysecond() - times.wall[5][k];
+    recordProfiling(times, 5, k, transfers);
+    assert(err==CL_SUCCESS);
+    return parallel;
+}
+
+/*
+*  Execute the benchmark with the arrays split into n partitions for
+*  n = 1, 2, 4, ... up to config.partitions. The kernels of all partitions
+*  are started at the same time under the same kernel name. The runtime
+*  dispatches concurrent launches of a kernel with num_compute_units to
+*  idle compute units, so with NUM_COMPUTE_UNITS >= n every partition can
+*  be processed by its own compute unit. Whether this happened is checked
+*  with the profiling events: the Parallel column is only "yes" if the
+*  kernels of all partitions overlapped in every iteration. For every n a
+*  row with the best device rates and the speedup of the kernels compared
+*  to a single partition is printed.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void runPartitionScaling(StreamDevice<T>& dev)
+{
+    StreamTimings times(config.ntimes);
+    double single_rate = 0.0;
+
+    printf("Scaling over 1 to %u partitions of the arrays\n", config.partitions);
+    printf(HLINE);
+    printf("Device rates in MB/s. Speedup of the summed kernel rates compared to one partition\n");
+    printf("%10s %10s %10s %10s %10s %10s %10s %8s %8s %6s\n", "Partitions", "Copy", "Scale", "Add", "Triad",
+           "PCI Write", "PCI Read", "Speedup", "Parallel", "Valid");
+    unsigned n = 1;
+    while (true) {
+        std::vector<size_t> lengths;
+        std::vector<StreamDevice<T> > parts = createPartitions(dev, n, lengths);
+        initializeArrays(dev.A, dev.B, dev.C, config.arraySize);
+        bool parallel = true;
+        for (unsigned k=0; k<config.ntimes; k++) {
+            parallel = executePartitioned(parts, lengths, times, k) && parallel;
+        }
+
+        double kernel_rate = 0.0;
+        printf("%10u", (unsigned) parts.size());
+        for (int j=0; j<6; j++) {
+            double rate = 1.0E-06 * bytes[j] / minTime(times.device[j]);
+            if (j < 4) {
+                kernel_rate += rate;
+            }
+            printf(" %10.1f", rate);
+        }
+        if (n == 1) {
+            single_rate = kernel_rate;
+        }
+        printf(" %8.2f %8s", kernel_rate / single_rate, parallel ? "yes" : "no");
+        printf(" %6s\n", checkSTREAMresults(dev.A, dev.B, dev.C, config.arraySize, true) == 0 ? "yes" : "no");
+        fflush(stdout);
+
+        if (n >= config.partitions) {
+            break;
+        }
+        n = MIN(2 * n, config.partitions);
+    }
+    printf(HLINE);
+}
+
+/*
+*  Execute the benchmark on all devices of the platform at the same time.
+*  Every device gets its own context, queue, buffers and host arrays and is
+*  driven by a separate host thread. The threads are synchronized with a
+*  barrier before every iteration, so the PCIe transfers and kernels of all
+*  devices overlap. The aggregate rate of an iteration is calculated from
+*  the bytes of all devices and the slowest device.
+*  Returns false if the setup of a device failed.
+*-----------------------------------------------------------------------*/
+template<typename T>
+bool runMultiDevice(std::vector<StreamProgram>& programs)
+{
+    unsigned num_devices = programs.size();
+    std::vector<StreamDevice<T> > devs(num_devices);
+    std::vector<StreamTimings> times(num_devices, StreamTimings(config.ntimes));
+    std::vector<int> errors(num_devices);
+
+    printf("Execute the benchmark on %u devices concurrently\n", num_devices);
+    for (unsigned d=0; d<num_devices; d++) {
+        if (!setupDevice(devs[d], programs[d])) {
+            std::cerr << "Not possible to set up device " << d << "!" << std::endl;
+            return false;
+        }
+        std::cout << "Device " << d << ":      " << programs[d].device.getInfo<CL_DEVICE_NAME>() << std::endl;
+    }
+    printf(HLINE);
+
+    ThreadBarrier barrier(num_devices);
+    std::vector<std::thread> threads;
+    for (unsigned d=0; d<num_devices; d++) {
+        threads.push_back(std::thread([&devs, &times, &errors, &barrier, d] {
+            initializeArrays(devs[d].A, devs[d].B, devs[d].C, config.arraySize);
+            executeIterations(devs[d], config.arraySize, times[d], false, &barrier);
+            errors[d] = checkSTREAMresults(devs[d].A, devs[d].B, devs[d].C, config.arraySize, true);
+        }));
+    }
+    for (unsigned d=0; d<num_devices; d++) {
+        threads[d].join();
+    }
+
+    printf("Best rates in MB/s\n");
+    printf("%-12s", "Device");
+    for (int j=0; j<6; j++) {
+        printf(" %s", label[j].c_str());
+    }
+    printf(" Valid\n");
+    for (unsigned d=0; d<num_devices; d++) {
+        printf("%-12u", d);
+        for (int j=0; j<6; j++) {
+            printf(" %11.1f", 1.0E-06 * bytes[j] / minTime(times[d].wall[j]));
+        }
+        printf(" %5s\n", errors[d] == 0 ? "yes" : "no");
+    }
+    printf("%-12s", "Aggregate");
+    for (int j=0; j<6; j++) {
+        std::vector<double> slowest(config.ntimes, 0.0);
+        for (unsigned k=0; k<config.ntimes; k++) {
+            for (unsigned d=0; d<num_devices; d++) {
+                slowest[k] = MAX(slowest[k], times[d].wall[j][k]);
+            }
+        }
+        printf(" %11.1f", 1.0E-06 * num_devices * bytes[j] / minTime(slowest));
+    }
+    printf("\n");
+    printf(HLINE);
+
+    for (unsigned d=0; d<num_devices; d++) {
+        freeDevice(devs[d]);
+    }
+    return true;
+}
+
+/*
+*  Number of host threads used for the CPU backend, the initialization and
+*  the validation of the arrays. By default one thread per core.
+*-----------------------------------------------------------------------*/
+unsigned hostThreads()
+{
+    if (config.cpuThreads > 0) {
+        return config.cpuThreads;
+    }
+    return MAX(std::thread::hardware_concurrency(), 1u);
+}
+
+/*
+*  Number of elements of the partitions when array_size elements are
+*  distributed over num_threads threads. The partitions start at multiples
+*  of 64 bytes, so they can be processed with aligned vector accesses.
+*-----------------------------------------------------------------------*/
+template<typename T>
+size_t partitionSize(size_t array_size, unsigned num_threads)
+{
+    const size_t align = 64 / sizeof(T);
+    return ((array_size + num_threads - 1) / num_threads + align - 1) / align * align;
+}
+
+/*
+*  Call body(thread, begin, end) for the partitions of the range
+*  [0, array_size) in parallel on hostThreads() threads.
+*  Small ranges are processed by the calling thread, because starting the
+*  threads would take longer than the work itself.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void parallelFor(size_t array_size, const std::function<void(unsigned, size_t, size_t)>& body)
+{
+    unsigned num_threads = hostThreads();
+    if (array_size < (1 << 16) || num_threads == 1) {
+        body(0, 0, array_size);
+        return;
+    }
+    size_t partition = partitionSize<T>(array_size, num_threads);
+    std::vector<std::thread> threads;
+    for (unsigned t=0; t<num_threads; t++) {
+        size_t begin = MIN(t * partition, array_size);
+        size_t end = MIN(begin + partition, array_size);
+        threads.push_back(std::thread(body, t, begin, end));
+    }
+    for (unsigned t=0; t<num_threads; t++) {
+        threads[t].join();
+    }
+}
+
+/*
+*  Fill the range [begin, end) of the arrays with the values a, b and c.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void fillArrays(T* A, T* B, T* C, size_t begin, size_t end,
+                T a, T b, T c)
+{
+    for (size_t j=begin; j<end; j++) {
+        A[j] = a;
+        B[j] = b;
+        C[j] = c;
+    }
+}
+
+/*
+*  Initialize the arrays in parallel with the values they have in the
+*  default mode after the timing check, which scales A by 2.0.
+*  These values are expected by checkSTREAMresults().
+*-----------------------------------------------------------------------*/
+template<typename T>
+void initializeArrays(T* A, T* B, T* C, size_t array_size)
+{
+    parallelFor<T>(array_size, [A, B, C](unsigned t, size_t begin, size_t end) {
+        fillArrays<T>(A, B, C, begin, end, 2.0, 2.0, 0.0);
+    });
+}
+
+/*-----------------------------------------------------------------------
+ * Host CPU backend
+ *
+ * Executes the four STREAM kernels on the host CPU with config.cpuThreads
+ * threads. Every thread works on its own contiguous partition of the
+ * arrays and initializes it itself, so the pages are placed on the NUMA
+ * node of the thread by the first touch policy. The threads are pinned
+ * round robin over the NUMA nodes.
+ * The kernels are vectorized with AVX-512 or AVX2 if the CPU supports it.
+ * Optionally, the results are written with non-temporal stores that
+ * bypass the caches.
+ *-----------------------------------------------------------------------*/
+
+/*
+*  Scalar kernel op (0 = copy, 1 = scale, 2 = add, 3 = triad) on the range
+*  [begin, end). Also processes the remainder of the vectorized kernels.
+*/
+template<typename T>
+void cpuKernelScalar(int op, T* a, T* b, T* c,
+                     T scalar, size_t begin, size_t end)
+{
+    switch (op) {
+        case 0: for (size_t j=begin; j<end; j++) c[j] = a[j]; break;
+        case 1: for (size_t j=begin; j<end; j++) b[j] = scalar * c[j]; break;
+        case 2: for (size_t j=begin; j<end; j++) c[j] = a[j] + b[j]; break;
+        default: for (size_t j=begin; j<end; j++) a[j] = b[j] + scalar * c[j]; break;
+    }
+}
+
+#ifdef HOST_SIMD
+#define AVX2_FN __attribute__((target("avx2"))) static inline
+#define AVX512_FN __attribute__((target("avx512f"))) static inline
+
+template<typename T> struct AVX2Ops;
+template<> struct AVX2Ops<cl_double> {
+    typedef __m256d vec;
+    AVX2_FN vec load(const cl_double* p) { return _mm256_load_pd(p); }
+    AVX2_FN vec loadu(const cl_double* p) { return _mm256_loadu_pd(p); }
+    AVX2_FN vec set1(cl_double s) { return _mm256_set1_pd(s); }
+    AVX2_FN vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+    AVX2_FN vec sub(vec a, vec b) { return _mm256_sub_pd(a, b); }
+    AVX2_FN vec abs(vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    AVX2_FN vec mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+    AVX2_FN void store(cl_double* p, vec v) { _mm256_store_pd(p, v); }
+    AVX2_FN void stream(cl_double* p, vec v) { _mm256_stream_pd(p, v); }
+};
+template<> struct AVX2Ops<cl_float> {
+    typedef __m256 vec;
+    AVX2_FN vec load(const cl_float* p) { return _mm256_load_ps(p); }
+    AVX2_FN vec loadu(const cl_float* p) { return _mm256_loadu_ps(p); }
+    AVX2_FN vec set1(cl_float s) { return _mm256_set1_ps(s); }
+    AVX2_FN vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+    AVX2_FN vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+    AVX2_FN vec abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    AVX2_FN vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+    AVX2_FN void store(cl_float* p, vec v) { _mm256_store_ps(p, v); }
+    AVX2_FN void stream(cl_float* p, vec v) { _mm256_stream_ps(p, v); }
+};
+
+template<typename T> struct AVX512Ops;
+template<> struct AVX512Ops<cl_double> {
+    typedef __m512d vec;
+    AVX512_FN vec load(const cl_double* p) { return _mm512_load_pd(p); }
+    AVX512_FN vec loadu(const cl_double* p) { return _mm512_loadu_pd(p); }
+    AVX512_FN vec set1(cl_double s) { return _mm512_set1_pd(s); }
+    AVX512_FN vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+    AVX512_FN vec sub(vec a, vec b) { return _mm512_sub_pd(a, b); }
+    AVX512_FN vec abs(vec a) { return _mm512_abs_pd(a); }
+    AVX512_FN vec mul(vec a, vec b) { return _mm512_mul_pd(a, b); }
+    AVX512_FN void store(cl_double* p, vec v) { _mm512_store_pd(p, v); }
+    AVX512_FN void stream(cl_double* p, vec v) { _mm512_stream_pd(p, v); }
+};
+template<> struct AVX512Ops<cl_float> {
+    typedef __m512 vec;
+    AVX512_FN vec load(const cl_float* p) { return _mm512_load_ps(p); }
+    AVX512_FN vec loadu(const cl_float* p) { return _mm512_loadu_ps(p); }
+    AVX512_FN vec set1(cl_float s) { return _mm512_set1_ps(s); }
+    AVX512_FN vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+    AVX512_FN vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+    AVX512_FN vec abs(vec a) { return _mm512_abs_ps(a); }
+    AVX512_FN vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+    AVX512_FN void store(cl_float* p, vec v) { _mm512_store_ps(p, v); }
+    AVX512_FN void stream(cl_float* p, vec v) { _mm512_stream_ps(p, v); }
+};
+
+/*
+*  Vectorized kernel op (0 = copy, 1 = scale, 2 = add, 3 = triad) on the
+*  range [begin, end). begin has to be aligned to the vector width, the
+*  remaining elements at the end are processed with scalar code.
+*/
+#define CPU_VECTOR_LOOP(OUT, EXPR)                                            \
+    if (nt) {                                                                 \
+        for (size_t j=begin; j<vec_end; j+=width) ops::stream(OUT + j, EXPR); \
+        _mm_sfence();                                                         \
+    }                                                                         \
+    else {                                                                    \
+        for (size_t j=begin; j<vec_end; j+=width) ops::store(OUT + j, EXPR);  \
+    }
+
+#define CPU_KERNEL_BODY(OPS)                                                  \
+    typedef OPS<T> ops;                                                       \
+    typedef typename ops::vec vec;                                            \
+    const size_t width = sizeof(vec) / sizeof(T);                             \
+    size_t vec_end = begin + (end - begin) / width * width;                   \
+    vec s = ops::set1(scalar);                                                \
+    switch (op) {                                                             \
+        case 0: CPU_VECTOR_LOOP(c, ops::load(a + j)) break;                   \
+        case 1: CPU_VECTOR_LOOP(b, ops::mul(s, ops::load(c + j))) break;      \
+        case 2: CPU_VECTOR_LOOP(c, ops::add(ops::load(a + j), ops::load(b + j))) break; \
+        default: CPU_VECTOR_LOOP(a, ops::add(ops::load(b + j), ops::mul(s, ops::load(c + j)))) break; \
+    }                                                                         \
+    cpuKernelScalar(op, a, b, c, scalar, vec_end, end);
+
+template<typename T>
+__attribute__((target("avx2")))
+void cpuKernelAVX2(int op, T* a, T* b, T* c,
+                   T scalar, size_t begin, size_t end, bool nt)
+{
+    CPU_KERNEL_BODY(AVX2Ops)
+}
+
+template<typename T>
+__attribute__((target("avx512f")))
+void cpuKernelAVX512(int op, T* a, T* b, T* c,
+                     T scalar, size_t begin, size_t end, bool nt)
+{
+    CPU_KERNEL_BODY(AVX512Ops)
+}
+#endif
+
+/*
+*  Sum with Kahan compensation, so the accumulated error of the validation
+*  stays accurate also for arrays with billions of elements.
+*-----------------------------------------------------------------------*/
+template<typename T>
+struct KahanSum {
+    T sum, compensation;
+
+    KahanSum() : sum(0.0), compensation(0.0) {}
+
+    void add(T value) {
+        T y = value - compensation;
+        T t = sum + y;
+        compensation = (t - sum) - y;
+        sum = t;
+    }
+};
+
+/*
+*  Accumulate the absolute differences of A, B and C to the expected values
+*  in the range [begin, end) in a single pass over the arrays.
+*/
+template<typename T>
+void errorSumsScalar(const T* A, const T* B, const T* C,
+                     const T expected[3], size_t begin, size_t end, KahanSum<T> sums[3])
+{
+    for (size_t j=begin; j<end; j++) {
+        sums[0].add(fabs(A[j] - expected[0]));
+        sums[1].add(fabs(B[j] - expected[1]));
+        sums[2].add(fabs(C[j] - expected[2]));
+    }
+}
+
+#ifdef HOST_SIMD
+/*
+*  Vectorized version of errorSumsScalar(). Every vector lane has its own
+*  compensated sum, the lanes are added up at the end. The arrays may have
+*  any alignment.
+*/
+#define ERROR_SUMS_BODY(OPS)                                                  \
+    typedef OPS<T> ops;                                                       \
+    typedef typename ops::vec vec;                                            \
+    const size_t width = sizeof(vec) / sizeof(T);                             \
+    size_t vec_end = begin + (end - begin) / width * width;                   \
+    const T* arrays[3] = {A, B, C};                                           \
+    vec exp[3], sum[3], comp[3];                                              \
+    for (int i=0; i<3; i++) {                                                 \
+        exp[i] = ops::set1(expected[i]);                                      \
+        sum[i] = ops::set1(0.0);                                              \
+        comp[i] = ops::set1(0.0);                                             \
+    }                                                                         \
+    for (size_t j=begin; j<vec_end; j+=width) {                               \
+        for (int i=0; i<3; i++) {                                             \
+            vec y = ops::sub(ops::abs(ops::sub(ops::loadu(arrays[i] + j), exp[i])), comp[i]); \
+            vec t = ops::add(sum[i], y);                                      \
+            comp[i] = ops::sub(ops::sub(t, sum[i]), y);                       \
+            sum[i] = t;                                                       \
+        }                                                                     \
+    }                                                                         \
+    alignas(64) T lane_sum[width], lane_comp[width];                          \
+    for (int i=0; i<3; i++) {                                                 \
+        ops::store(lane_sum, sum[i]);                                         \
+        ops::store(lane_comp, comp[i]);                                       \
+        for (size_t l=0; l<width; l++) {                                     \
+            sums[i].add(lane_sum[l]);                                         \
+            sums[i].add(-lane_comp[l]);                                       \
+        }                                                                     \
+    }                                                                         \
+    errorSumsScalar(A, B, C, expected, vec_end, end, sums);
+
+template<typename T>
+__attribute__((target("avx2")))
+void errorSumsAVX2(const T* A, const T* B, const T* C,
+                   const T expected[3], size_t begin, size_t end, KahanSum<T> sums[3])
+{
+    ERROR_SUMS_BODY(AVX2Ops)
+}
+
+template<typename T>
+__attribute__((target("avx512f")))
+void errorSumsAVX512(const T* A, const T* B, const T* C,
+                     const T expected[3], size_t begin, size_t end, KahanSum<T> sums[3])
+{
+    ERROR_SUMS_BODY(AVX512Ops)
+}
+#endif
+
+/*
+*  Execute kernel op or accumulate the errors with the given instruction
+*  set. Only float and double have vectorized versions, the other element
+*  types always use the scalar code.
+*/
+template<typename T>
+void cpuKernel(CpuISA isa, int op, T* a, T* b, T* c, T scalar, size_t begin, size_t end, bool nt,
+               std::true_type)
+{
+    switch (isa) {
+#ifdef HOST_SIMD
+        case CPU_ISA_AVX512: cpuKernelAVX512(op, a, b, c, scalar, begin, end, nt); break;
+        case CPU_ISA_AVX2: cpuKernelAVX2(op, a, b, c, scalar, begin, end, nt); break;
+#endif
+        default: cpuKernelScalar(op, a, b, c, scalar, begin, end); break;
+    }
+}
+
+template<typename T>
+void cpuKernel(CpuISA isa, int op, T* a, T* b, T* c, T scalar, size_t begin, size_t end, bool nt,
+               std::false_type)
+{
+    cpuKernelScalar(op, a, b, c, scalar, begin, end);
+}
+
+template<typename T>
+void errorSumsISA(CpuISA isa, const T* A, const T* B, const T* C, const T expected[3],
+                  size_t begin, size_t end, KahanSum<T> sums[3], std::true_type)
+{
+    switch (isa) {
+#ifdef HOST_SIMD
+        case CPU_ISA_AVX512: errorSumsAVX512(A, B, C, expected, begin, end, sums); break;
+        case CPU_ISA_AVX2: errorSumsAVX2(A, B, C, expected, begin, end, sums); break;
+#endif
+        default: errorSumsScalar(A, B, C, expected, begin, end, sums); break;
+    }
+}
+
+template<typename T>
+void errorSumsISA(CpuISA isa, const T* A, const T* B, const T* C, const T expected[3],
+                  size_t begin, size_t end, KahanSum<T> sums[3], std::false_type)
+{
+    errorSumsScalar(A, B, C, expected, begin, end, sums);
+}
+
+/*
+*  Select the instruction set for the host kernels. With "auto" the widest
+*  vector extension supported by the CPU is used. Element types without
+*  vectorized kernels use the scalar kernels.
+*-----------------------------------------------------------------------*/
+template<typename T>
+CpuISA selectCpuISA()
+{
+#ifdef HOST_SIMD
+    __builtin_cpu_init();
+    bool avx512 = std::is_floating_point<T>::value && __builtin_cpu_supports("avx512f");
+    bool avx2 = std::is_floating_point<T>::value && __builtin_cpu_supports("avx2");
+#else
+    bool avx512 = false;
+    bool avx2 = false;
+#endif
+    switch (config.cpuISA) {
+        case CPU_ISA_AVX512: return avx512 ? CPU_ISA_AVX512 : (avx2 ? CPU_ISA_AVX2 : CPU_ISA_SCALAR);
+        case CPU_ISA_AVX2: return avx2 ? CPU_ISA_AVX2 : CPU_ISA_SCALAR;
+        case CPU_ISA_SCALAR: return CPU_ISA_SCALAR;
+        default: return avx512 ? CPU_ISA_AVX512 : (avx2 ? CPU_ISA_AVX2 : CPU_ISA_SCALAR);
+    }
+}
+
+/*
+*  Accumulate the absolute errors of the first array_size elements of A, B
+*  and C in parallel with the widest available instruction set.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void errorSums(const T* A, const T* B, const T* C,
+               const T expected[3], size_t array_size, T sums[3])
+{
+    CpuISA isa = selectCpuISA<T>();
+    std::vector<KahanSum<T> > partial(3 * hostThreads());
+    parallelFor<T>(array_size, [&](unsigned t, size_t begin, size_t end) {
+        errorSumsISA(isa, A, B, C, expected, begin, end, &partial[3 * t], std::is_floating_point<T>());
+    });
+    for (int i=0; i<3; i++) {
+        KahanSum<T> total;
+        for (size_t t=i; t<partial.size(); t+=3) {
+            total.add(partial[t].sum);
+            total.add(-partial[t].compensation);
         }
+        sums[i] = total.sum;
     }
+}
 
-    printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
-    for (j=0; j<6; j++) {
-    avgtime[j] = avgtime[j]/(double)(NTIMES-1);
+/*
+*  Return the CPUs the process may run on, ordered round robin over the
+*  NUMA nodes given in sysfs. Pinning thread i to the i-th CPU of the list
+*  spreads the threads evenly over the nodes.
+*-----------------------------------------------------------------------*/
+std::vector<int> cpuOrder()
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
 
-    printf("%s%12.1f  %11.6f  %11.6f  %11.6f\n", label[j].c_str(),
-           1.0E-06 * bytes[j]/mintime[j],
-           avgtime[j],
-           mintime[j],
-           maxtime[j]);
+    std::vector<std::vector<int> > nodes;
+    for (int n=0; ; n++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", n);
+        std::ifstream cpulist(path);
+        if (!cpulist.is_open()) {
+            break;
+        }
+        // list of ranges like "0-15,32-47"
+        std::vector<int> cpus;
+        std::string range;
+        while (std::getline(cpulist, range, ',')) {
+            int first = 0, last = 0;
+            int matched = sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (matched < 1) {
+                continue;
+            }
+            if (matched == 1) {
+                last = first;
+            }
+            for (int cpu=first; cpu<=last; cpu++) {
+                if (CPU_ISSET(cpu, &allowed)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        nodes.push_back(cpus);
+    }
+    if (nodes.empty()) {
+        nodes.push_back(std::vector<int>());
+        for (int cpu=0; cpu<CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                nodes[0].push_back(cpu);
+            }
+        }
     }
-    printf(HLINE);
 
-    /* --- Check Results --- */
-    checkSTREAMresults();
+    std::vector<int> order;
+    for (size_t i=0; ; i++) {
+        size_t added = 0;
+        for (size_t n=0; n<nodes.size(); n++) {
+            if (i < nodes[n].size()) {
+                order.push_back(nodes[n][i]);
+                added++;
+            }
+        }
+        if (added == 0) {
+            break;
+        }
+    }
+    return order;
+}
+
+/*
+*  Execute config.ntimes iterations of the four kernels on the host CPU.
+*  The times of the kernels are stored in times[0..3][iteration].
+*  Returns the number of arrays that failed the validation or -1 if the
+*  arrays could not be allocated.
+*-----------------------------------------------------------------------*/
+template<typename T>
+int runCpuBackend(std::vector<std::vector<double> >& times)
+{
+    unsigned num_threads = hostThreads();
+    CpuISA isa = selectCpuISA<T>();
+    std::vector<int> cpus = cpuOrder();
+    T scalar = 3.0;
+
+    // The vectorized kernels need arrays that are aligned to at least 64 bytes
+    size_t alignment = MAX(config.alignment, (size_t) 64);
+    T* a = allocateAlignedArray<T>(config.arraySize, alignment);
+    T* b = allocateAlignedArray<T>(config.arraySize, alignment);
+    T* c = allocateAlignedArray<T>(config.arraySize, alignment);
+    if (a == NULL || b == NULL || c == NULL) {
+        free(a);
+        free(b);
+        free(c);
+        return -1;
+    }
+
+    printf("Host CPU: %u threads, %s kernels, %s stores\n", num_threads, cpuISANames[isa],
+           config.cpuNonTemporal ? "non-temporal" : "regular");
+
+    size_t partition = partitionSize<T>(config.arraySize, num_threads);
+
+    ThreadBarrier barrier(num_threads);
+    double start = 0.0;
+    std::vector<std::thread> threads;
+    for (unsigned t=0; t<num_threads; t++) {
+        threads.push_back(std::thread([&, t] {
+            if (!cpus.empty()) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpus[t % cpus.size()], &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            }
+            size_t begin = MIN(t * partition, config.arraySize);
+            size_t last = MIN(begin + partition, config.arraySize);
+            fillArrays<T>(a, b, c, begin, last, 2.0, 2.0, 0.0);
+            for (unsigned k=0; k<config.ntimes; k++) {
+                for (int op=0; op<4; op++) {
+                    barrier.wait();
+                    if (t == 0) {
+                        start = mysecond();
+                    }
+                    cpuKernel(isa, op, a, b, c, scalar, begin, last, config.cpuNonTemporal,
+                              std::is_floating_point<T>());
+                    barrier.wait();
+                    if (t == 0) {
+                        times[op][k] = mysecond() - start;
+                    }
+                }
+            }
+        }));
+    }
+    for (unsigned t=0; t<num_threads; t++) {
+        threads[t].join();
+    }
+
+    int err = checkSTREAMresults(a, b, c, config.arraySize, true);
+    free(a);
+    free(b);
+    free(c);
+    return err;
+}
+
+/*
+*  Print the results of the host CPU backend as additional rows of the
+*  result table.
+*-----------------------------------------------------------------------*/
+template<typename T>
+void printCpuResults(const std::vector<std::vector<double> >& times)
+{
+    for (int j=0; j<4; j++) {
+        double kernel_bytes = ((j == 0 || j == 1) ? 2 : 3) * sizeof(T) * (double) config.arraySize;
+        printf("%s%12.1f  %11.6f  %11.6f  %11.6f\n", cpuLabel[j].c_str(),
+               1.0E-06 * kernel_bytes/minTime(times[j]),
+               avgTime(times[j]),
+               minTime(times[j]),
+               maxTime(times[j]));
+    }
+}
+
+/*
+*  Execute only the host CPU backend without using OpenCL at all.
+*-----------------------------------------------------------------------*/
+template<typename T>
+int runCpuOnly()
+{
+    std::vector<std::vector<double> > times(4, std::vector<double>(config.ntimes));
+    int err = runCpuBackend<T>(times);
+    if (err < 0) {
+        std::cerr << "Not possible to allocate the host arrays!" << std::endl;
+        return 1;
+    }
+    printf(HLINE);
+    printf("Function    Best Rate MB/s  Avg time     Min time     Max time\n");
+    printCpuResults<T>(times);
+    printf(HLINE);
+    if (err == 0) {
+        printf("Host CPU Solution Validates\n");
+    }
+    else {
+        printf("Failed Validation of the host CPU results on %d arrays\n", err);
+    }
     printf(HLINE);
     return 0;
 }
+/*
+*  Create the result record of the default mode in the column schema of the
+*  files in csv_result_export: fmax followed by rate, average, minimum and
+*  maximum time of copy, scale, add, triad, PCIe write and PCIe read.
+*  The rates are given in MB/s, the times in seconds.
+*-----------------------------------------------------------------------*/
+template<typename T>
+ResultRecord createResultRecord(const StreamDevice<T>& dev, const StreamTimings& times)
+{
+    ResultRecord record;
+    if (!config.resultName.empty()) {
+        record.name = config.resultName;
+    }
+    else {
+        // Same naming as in csv_result_export, e.g. 19-2_ni
+        record.name = QUARTUS_VERSION;
+        std::replace(record.name.begin(), record.name.end(), '.', '-');
+        if (!interleavedPlacement()) {
+            record.name += "_ni";
+        }
+        if (config.indexBits == 64) {
+            record.name += config.indexTiled ? "_i64t" : "_i64";
+        }
+    }
+
+    record.columns.push_back("fmax");
+    record.values.push_back(config.fmax);
+    for (int j=0; j<6; j++) {
+        std::string prefix = resultNames[j];
+        record.columns.push_back(prefix + "_rate");
+        record.values.push_back(1.0E-06 * bytes[j] / minTime(times.wall[j]));
+        record.columns.push_back(prefix + "_avg_time");
+        record.values.push_back(avgTime(times.wall[j]));
+        record.columns.push_back(prefix + "_min_time");
+        record.values.push_back(minTime(times.wall[j]));
+        record.columns.push_back(prefix + "_max_time");
+        record.values.push_back(maxTime(times.wall[j]));
+    }
+
+    char array_size[32];
+    snprintf(array_size, sizeof(array_size), "%llu", (unsigned long long) config.arraySize);
+    char unroll_count[32] = "unknown";
+#ifdef UNROLL_COUNT
+    snprintf(unroll_count, sizeof(unroll_count), "%d", UNROLL_COUNT);
+#endif
+    record.metadata.push_back(std::make_pair("board", std::string(BOARD_NAME)));
+    const cl::Device& device = dev.device;
+    record.metadata.push_back(std::make_pair("device", device.getInfo<CL_DEVICE_NAME>()));
+    record.metadata.push_back(std::make_pair("quartus_version", std::string(QUARTUS_VERSION)));
+    record.metadata.push_back(std::make_pair("stream_type", std::string(StreamTypeName<T>::host())));
+    record.metadata.push_back(std::make_pair("unroll_count", std::string(unroll_count)));
+    record.metadata.push_back(std::make_pair("vector_width", std::to_string(config.vectorWidth)));
+    record.metadata.push_back(std::make_pair("array_index", indexName()));
+    record.metadata.push_back(std::make_pair("interleaving", std::string(interleavedPlacement() ? "yes" : "no")));
+    record.metadata.push_back(std::make_pair("banks", placementName()));
+    record.metadata.push_back(std::make_pair("channels", std::string(config.channelKernels ? "yes" : "no")));
+    record.metadata.push_back(std::make_pair("array_size", std::string(array_size)));
+    record.metadata.push_back(std::make_pair("kernel_file", config.kernelFile));
+    record.metadata.push_back(std::make_pair("time_to_first_kernel", std::to_string(firstKernelTime)));
+    return record;
+}
+
+/*
+*  Quote a CSV field if it contains a separator or quotes.
+*/
+std::string csvField(const std::string& value)
+{
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (size_t i=0; i<value.size(); i++) {
+        if (value[i] == '"') {
+            quoted += '"';
+        }
+        quoted += value[i];
+    }
+    return quoted + "\"";
+}
+
+/*
+*  Split a line of a CSV file into its fields.
+*/
+std::vector<std::string> splitCSVLine(const std::string& line)
+{
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i=0; i<line.size(); i++) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += c;
+                i++;
+            }
+            else if (c == '"') {
+                quoted = false;
+            }
+            else {
+                fields.back() += c;
+            }
+        }
+        else if (c == '"') {
+            quoted = true;
+        }
+        else if (c == ',') {
+            fields.push_back("");
+        }
+        else if (c != '\r') {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+/*
+*  Append the record as a row to the given CSV file. The header is written
+*  only if the file is empty, so the results of several runs can be
+*  collected in one file. The metadata is appended after the result columns.
+*  Returns false if the file could not be written.
+*-----------------------------------------------------------------------*/
+bool writeCSV(const ResultRecord& record, const std::string& file_name)
+{
+    std::ifstream existing(file_name.c_str());
+    bool write_header = !existing.is_open() || existing.peek() == std::ifstream::traits_type::eof();
+    existing.close();
+
+    std::ofstream csv(file_name.c_str(), std::ofstream::app);
+    if (!csv.is_open()) {
+        return false;
+    }
+    if (write_header) {
+        for (size_t i=0; i<record.columns.size(); i++) {
+            csv << "," << record.columns[i];
+        }
+        for (size_t i=0; i<record.metadata.size(); i++) {
+            csv << "," << record.metadata[i].first;
+        }
+        csv << std::endl;
+    }
+    csv << csvField(record.name);
+    for (size_t i=0; i<record.columns.size(); i++) {
+        // Same precision as the tables, the fmax is left empty if it is unknown
+        char value[32] = "";
+        const std::string& column = record.columns[i];
+        if (column == "fmax") {
+            if (record.values[i] > 0.0) {
+                snprintf(value, sizeof(value), "%.2f", record.values[i]);
+            }
+        }
+        else if (column.compare(column.size() - 5, 5, "_rate") == 0) {
+            snprintf(value, sizeof(value), "%.1f", record.values[i]);
+        }
+        else {
+            snprintf(value, sizeof(value), "%.6f", record.values[i]);
+        }
+        csv << "," << value;
+    }
+    for (size_t i=0; i<record.metadata.size(); i++) {
+        csv << "," << csvField(record.metadata[i].second);
+    }
+    csv << std::endl;
+    return csv.good();
+}
+
+/*
+*  Escape a string for the use in a JSON file.
+*/
+std::string jsonString(const std::string& value)
+{
+    std::string escaped = "\"";
+    for (size_t i=0; i<value.size(); i++) {
+        char c = value[i];
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((unsigned char) c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped + "\"";
+}
+
+/*
+*  Write the record to the given JSON file. The results use the same keys
+*  as the columns of the CSV file.
+*  Returns false if the file could not be written.
+*-----------------------------------------------------------------------*/
+bool writeJSON(const ResultRecord& record, const std::string& file_name)
+{
+    std::ofstream json(file_name.c_str());
+    if (!json.is_open()) {
+        return false;
+    }
+    json << "{" << std::endl;
+    json << "  \"name\": " << jsonString(record.name) << "," << std::endl;
+    json << "  \"metadata\": {" << std::endl;
+    for (size_t i=0; i<record.metadata.size(); i++) {
+        json << "    " << jsonString(record.metadata[i].first) << ": " << jsonString(record.metadata[i].second)
+             << (i + 1 < record.metadata.size() ? "," : "") << std::endl;
+    }
+    json << "  }," << std::endl;
+    json << "  \"results\": {" << std::endl;
+    for (size_t i=0; i<record.columns.size(); i++) {
+        char value[32] = "null";
+        if (record.columns[i] != "fmax" || record.values[i] > 0.0) {
+            snprintf(value, sizeof(value), "%.9g", record.values[i]);
+        }
+        json << "    " << jsonString(record.columns[i]) << ": " << value
+             << (i + 1 < record.columns.size() ? "," : "") << std::endl;
+    }
+    json << "  }" << std::endl;
+    json << "}" << std::endl;
+    return json.good();
+}
+
+/*
+*  Compare the rates of the record with a baseline CSV file in the schema
+*  of csv_result_export. The last row with the same name as the record is
+*  used as baseline. Rates without a positive baseline value are skipped.
+*  A rate that is more than config.regressionThreshold percent below the
+*  baseline counts as regression.
+*  Returns the number of regressions, -1 if the baseline could not be read
+*  or -2 if it has no row with the name of the record.
+*-----------------------------------------------------------------------*/
+int compareBaseline(const ResultRecord& record, const std::string& file_name)
+{
+    std::ifstream csv(file_name.c_str());
+    if (!csv.is_open()) {
+        return -1;
+    }
+    std::string line;
+    if (!std::getline(csv, line)) {
+        return -1;
+    }
+    std::vector<std::string> header = splitCSVLine(line);
+    std::vector<std::string> baseline;
+    while (std::getline(csv, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<std::string> row = splitCSVLine(line);
+        if (!row.empty() && row[0] == record.name) {
+            baseline = row;
+        }
+    }
+    if (baseline.empty()) {
+        return -2;
+    }
+
+    printf("Comparison with baseline '%s' from %s (threshold %.1f%%):\n", baseline[0].c_str(),
+           file_name.c_str(), config.regressionThreshold);
+    printf("Function    Baseline MB/s  Current MB/s  Change\n");
+    int regressions = 0;
+    for (size_t i=0; i<record.columns.size(); i++) {
+        const std::string& column = record.columns[i];
+        if (column.size() < 5 || column.compare(column.size() - 5, 5, "_rate") != 0) {
+            continue;
+        }
+        size_t c = std::find(header.begin(), header.end(), column) - header.begin();
+        if (c >= header.size() || c >= baseline.size() || baseline[c].empty()) {
+            continue;
+        }
+        double reference = strtod(baseline[c].c_str(), NULL);
+        if (!(reference > 0.0)) {
+            continue;
+        }
+        double change = 100.0 * (record.values[i] / reference - 1.0);
+        bool regression = change < -config.regressionThreshold;
+        regressions += regression ? 1 : 0;
+        printf("%-12s%13.1f  %12.1f  %+6.1f%%%s\n", column.substr(0, column.size() - 5).c_str(),
+               reference, record.values[i], change, regression ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+/*
+*  Print the available command line options together with their defaults.
+*-----------------------------------------------------------------------*/
+void printUsage(const char * name)
+{
+    printf("Usage: %s [OPTIONS] [KERNEL_FILE]\n\n", name);
+    printf("Options:\n");
+    printf("  -f, --kernel FILE     Kernel file that is used to program the FPGA (default: %s)\n", STREAM_FPGA_KERNEL);
+    printf("  -s, --size N|auto     Number of elements per array (default: %llu).\n", (unsigned long long) STREAM_ARRAY_SIZE);
+    printf("                        With 'auto' the arrays are sized to the memory of the device.\n");
+    printf("  -n, --ntimes N        Number of iterations, at least 2 (default: %d)\n", NTIMES);
+    printf("  -o, --offset N        Array offset in elements (default: %d)\n", OFFSET);
+    printf("  -p, --platform N      Index of the OpenCL platform (default: %d)\n", PLATFORM_ID);
+    printf("  -d, --device N        Index of the device within the platform (default: %d)\n", DEVICE_ID);
+    printf("  -a, --alignment N     Alignment of the host arrays in bytes (default: %d)\n", HOST_DATA_ALIGNMENT);
+    printf("      --sweep           Execute the benchmark for a geometric series of array sizes\n");
+    printf("                        up to the size given with -s\n");
+    printf("      --sweep-min N     Smallest array size of the sweep in elements (default: %d bytes per array)\n",
+           SWEEP_MIN_BYTES);
+    printf("      --sweep-factor F  Factor between two array sizes of the sweep (default: 2.0)\n");
+    printf("      --concurrent      Execute all kernels concurrently on separate queues and buffers\n");
+    printf("      --all-devices     Execute the benchmark on all devices of the platform concurrently\n");
+    printf("      --pipeline        Stream the arrays in chunks through the device and overlap\n");
+    printf("                        the transfers with the kernel execution\n");
+    printf("      --chunk-size N    Number of elements per chunk of the pipeline (default: %d)\n", 1 << 20);
+    printf("      --chunk-buffers N Number of buffer sets used by the pipeline, at least 2 (default: 3)\n");
+    printf("      --transfers LIST  Compare the PCIe transfers with the given comma separated list\n");
+    printf("                        of strategies: rw, pinned, hostptr, map, svm or all\n");
+    printf("      --pcie-sweep      Measure latency and rate of single buffer transfers from 64 bytes\n");
+    printf("                        up to the buffer size\n");
+    printf("      --cpu             Also execute the kernels on the host CPU and add the results\n");
+    printf("                        to the result table\n");
+    printf("      --cpu-only        Execute the kernels only on the host CPU without using OpenCL\n");
+    printf("      --cpu-threads N   Number of host threads for the CPU backend and the initialization\n");
+    printf("                        and validation of the arrays (default: all cores)\n");
+    printf("      --cpu-isa ISA     Instruction set of the host CPU kernels: scalar, avx2, avx512\n");
+    printf("                        or auto (default: auto)\n");
+    printf("      --nt-stores       Use non-temporal stores in the vectorized host CPU kernels\n");
+    printf("      --warmup N        Number of first iterations that are excluded from the results\n");
+    printf("                        (default: 1)\n");
+    printf("      --adaptive        Execute iterations until the confidence interval of the mean\n");
+    printf("                        rates is narrow enough or the time budget is used up\n");
+    printf("      --ci-target P     Width of the confidence interval in percent of the mean rate\n");
+    printf("                        at which the adaptive mode stops (default: 1.0)\n");
+    printf("      --time-budget S   Maximum runtime of the adaptive mode in seconds (default: 60)\n");
+    printf("      --csv FILE        Append the results to a CSV file in the schema of csv_result_export\n");
+    printf("      --json FILE       Write the results and build information to a JSON file\n");
+    printf("      --result-name N   Name of the result row (default: Quartus version, _ni suffix\n");
+    printf("                        without interleaving)\n");
+    printf("      --fmax MHZ        Kernel frequency that is added to the results and used for the\n");
+    printf("                        theoretical peak (default: from the aoc report next to the kernels)\n");
+    printf("      --ddr-speed MT/S  Transfer rate of the memory banks for the theoretical peak\n");
+    printf("                        (default: %d)\n", DDR_SPEED);
+    printf("      --baseline FILE   Compare the rates with a baseline CSV file and exit with an\n");
+    printf("                        error if a rate is below the baseline\n");
+    printf("      --regression-threshold P  Tolerated rate loss in percent (default: 5.0)\n");
+    printf("      --access-sweep    Measure strided, gather and scatter accesses with the kernels\n");
+    printf("                        of stream_kernels_access.cl\n");
+    printf("      --max-stride N    Largest stride of the access sweep in elements (default: 64)\n");
+    printf("      --banks LIST      Banks of the arrays A, B and C as comma separated list, e.g. 1,2,3,\n");
+    printf("                        or 'interleaved' (default: %s)\n", DEFAULT_BANKS_NAME);
+    printf("      --explore-banks   Execute the benchmark for all placements of the arrays on the banks\n");
+    printf("      --num-banks N     Number of memory banks of the board, at most 4 (default: 4)\n");
+    printf("      --channels        Use the reader, compute and writer kernels of stream_kernels_channels.cl\n");
+    printf("      --partitions N    Measure the scaling over 1, 2, 4, ... N partitions of the arrays\n");
+    printf("      --type TYPE       Element type of the kernels: half, float, double, int or long\n");
+    printf("                        (default: from the kernel manifest or argument metadata)\n");
+    printf("      --vector-width N  Vector width of the kernels, e.g. UNROLL_COUNT for stream_kernels_vec.cl\n");
+    printf("      --read-write      Measure the read and write bandwidth separately with the fill, sum\n");
+    printf("                        and read:write ratio kernels\n");
+    printf("      --launch-latency  Measure the latency of kernel launches and back-to-back launches\n");
+    printf("                        of tiny kernels\n");
+    printf("      --launches N      Number of kernel launches of the launch latency mode (default: 1000)\n");
+    printf("      --chained         Compare the isolated kernels with a chain of all iterations that is\n");
+    printf("                        enqueued without host synchronization\n");
+    printf("      --memory-latency  Measure the latency of dependent loads over working sets up to the\n");
+    printf("                        array size with the kernel of stream_kernels_access.cl\n");
+    printf("      --offset-sweep    Measure the kernels for array offsets from 0 to one memory burst\n");
+    printf("      --index-bits N    Width of the array size and offset arguments of the kernels, 32 or 64\n");
+    printf("                        (default: from the kernel manifest or 32)\n");
+    printf("      --skip-reprogram  Do not reprogram the FPGA if it holds the bitstream that this host\n");
+    printf("                        programmed last on the board, see $XDG_RUNTIME_DIR/%s\n",
+           PROGRAMMED_BITSTREAM_FILE);
+    printf("  -h, --help            Print this help message\n");
+}
+
+/*
+*  Parse the command line arguments into the global config.
+*  For compatibility with older versions, the first positional argument
+*  is interpreted as the kernel file.
+*  Returns false if the benchmark should not be executed.
+*-----------------------------------------------------------------------*/
+bool parseArguments(int argc, char * argv[])
+{
+    // Identifiers of the options that are only available as long option
+    enum { OPT_SWEEP = 256, OPT_SWEEP_MIN, OPT_SWEEP_FACTOR, OPT_CONCURRENT, OPT_ALL_DEVICES,
+           OPT_PIPELINE, OPT_CHUNK_SIZE, OPT_CHUNK_BUFFERS, OPT_TRANSFERS,
+           OPT_PCIE_SWEEP, OPT_CPU, OPT_CPU_ONLY, OPT_CPU_THREADS, OPT_CPU_ISA, OPT_NT_STORES,
+           OPT_WARMUP, OPT_ADAPTIVE, OPT_CI_TARGET, OPT_TIME_BUDGET, OPT_CSV, OPT_JSON,
+           OPT_RESULT_NAME, OPT_FMAX, OPT_BASELINE, OPT_REGRESSION_THRESHOLD,
+           OPT_ACCESS_SWEEP, OPT_MAX_STRIDE, OPT_BANKS, OPT_EXPLORE_BANKS, OPT_NUM_BANKS,
+           OPT_CHANNELS, OPT_PARTITIONS, OPT_TYPE, OPT_VECTOR_WIDTH, OPT_READ_WRITE,
+           OPT_LAUNCH_LATENCY, OPT_LAUNCHES, OPT_CHAINED, OPT_MEMORY_LATENCY,
+           OPT_OFFSET_SWEEP, OPT_INDEX_BITS, OPT_SKIP_REPROGRAM, OPT_DDR_SPEED };
+    static struct option long_options[] = {
+        {"kernel",    required_argument, 0, 'f'},
+        {"size",      required_argument, 0, 's'},
+        {"ntimes",    required_argument, 0, 'n'},
+        {"offset",    required_argument, 0, 'o'},
+        {"platform",  required_argument, 0, 'p'},
+        {"device",    required_argument, 0, 'd'},
+        {"alignment", required_argument, 0, 'a'},
+        {"sweep",        no_argument,       0, OPT_SWEEP},
+        {"sweep-min",    required_argument, 0, OPT_SWEEP_MIN},
+        {"sweep-factor", required_argument, 0, OPT_SWEEP_FACTOR},
+        {"concurrent",   no_argument,       0, OPT_CONCURRENT},
+        {"all-devices",  no_argument,       0, OPT_ALL_DEVICES},
+        {"pipeline",     no_argument,       0, OPT_PIPELINE},
+        {"chunk-size",   required_argument, 0, OPT_CHUNK_SIZE},
+        {"chunk-buffers", required_argument, 0, OPT_CHUNK_BUFFERS},
+        {"transfers",    required_argument, 0, OPT_TRANSFERS},
+        {"pcie-sweep",   no_argument,       0, OPT_PCIE_SWEEP},
+        {"cpu",          no_argument,       0, OPT_CPU},
+        {"cpu-only",     no_argument,       0, OPT_CPU_ONLY},
+        {"cpu-threads",  required_argument, 0, OPT_CPU_THREADS},
+        {"cpu-isa",      required_argument, 0, OPT_CPU_ISA},
+        {"nt-stores",    no_argument,       0, OPT_NT_STORES},
+        {"warmup",       required_argument, 0, OPT_WARMUP},
+        {"adaptive",     no_argument,       0, OPT_ADAPTIVE},
+        {"ci-target",    required_argument, 0, OPT_CI_TARGET},
+        {"time-budget",  required_argument, 0, OPT_TIME_BUDGET},
+        {"csv",          required_argument, 0, OPT_CSV},
+        {"json",         required_argument, 0, OPT_JSON},
+        {"result-name",  required_argument, 0, OPT_RESULT_NAME},
+        {"fmax",         required_argument, 0, OPT_FMAX},
+        {"baseline",     required_argument, 0, OPT_BASELINE},
+        {"regression-threshold", required_argument, 0, OPT_REGRESSION_THRESHOLD},
+        {"access-sweep", no_argument,       0, OPT_ACCESS_SWEEP},
+        {"max-stride",   required_argument, 0, OPT_MAX_STRIDE},
+        {"banks",        required_argument, 0, OPT_BANKS},
+        {"explore-banks", no_argument,      0, OPT_EXPLORE_BANKS},
+        {"num-banks",    required_argument, 0, OPT_NUM_BANKS},
+        {"channels",     no_argument,       0, OPT_CHANNELS},
+        {"partitions",   required_argument, 0, OPT_PARTITIONS},
+        {"type",         required_argument, 0, OPT_TYPE},
+        {"vector-width", required_argument, 0, OPT_VECTOR_WIDTH},
+        {"read-write",   no_argument,       0, OPT_READ_WRITE},
+        {"launch-latency", no_argument,     0, OPT_LAUNCH_LATENCY},
+        {"launches",     required_argument, 0, OPT_LAUNCHES},
+        {"chained",      no_argument,       0, OPT_CHAINED},
+        {"memory-latency", no_argument,     0, OPT_MEMORY_LATENCY},
+        {"offset-sweep", no_argument,       0, OPT_OFFSET_SWEEP},
+        {"index-bits",   required_argument, 0, OPT_INDEX_BITS},
+        {"skip-reprogram", no_argument,     0, OPT_SKIP_REPROGRAM},
+        {"ddr-speed",    required_argument, 0, OPT_DDR_SPEED},
+        {"help",      no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:s:n:o:p:d:a:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'f': config.kernelFile = optarg; break;
+            case 's':
+                if (std::string(optarg) == "auto") {
+                    config.autoArraySize = true;
+                }
+                else {
+                    config.autoArraySize = false;
+                    config.arraySize = strtoull(optarg, NULL, 10);
+                }
+                break;
+            case 'n': config.ntimes = strtoul(optarg, NULL, 10); break;
+            case 'o': config.offset = strtoul(optarg, NULL, 10); break;
+            case 'p': config.platformId = strtoul(optarg, NULL, 10); break;
+            case 'd': config.deviceId = strtoul(optarg, NULL, 10); break;
+            case 'a': config.alignment = strtoull(optarg, NULL, 10); break;
+            case OPT_SWEEP: config.mode = MODE_SWEEP; break;
+            case OPT_SWEEP_MIN: config.sweepMinSize = strtoull(optarg, NULL, 10); break;
+            case OPT_SWEEP_FACTOR: config.sweepFactor = strtod(optarg, NULL); break;
+            case OPT_CONCURRENT: config.mode = MODE_CONCURRENT; break;
+            case OPT_ALL_DEVICES: config.mode = MODE_MULTI_DEVICE; break;
+            case OPT_PIPELINE: config.mode = MODE_PIPELINE; break;
+            case OPT_CHUNK_SIZE: config.chunkSize = strtoull(optarg, NULL, 10); break;
+            case OPT_CHUNK_BUFFERS: config.chunkBuffers = strtoul(optarg, NULL, 10); break;
+            case OPT_PCIE_SWEEP: config.mode = MODE_PCIE_SWEEP; break;
+            case OPT_CPU: config.cpuBackend = true; break;
+            case OPT_CPU_ONLY: config.mode = MODE_CPU; break;
+            case OPT_CPU_THREADS: config.cpuThreads = strtoul(optarg, NULL, 10); break;
+            case OPT_NT_STORES: config.cpuNonTemporal = true; break;
+            case OPT_WARMUP: config.warmup = strtoul(optarg, NULL, 10); break;
+            case OPT_ADAPTIVE: config.adaptive = true; break;
+            case OPT_CI_TARGET: config.ciTarget = strtod(optarg, NULL); break;
+            case OPT_TIME_BUDGET: config.timeBudget = strtod(optarg, NULL); break;
+            case OPT_CSV: config.csvFile = optarg; break;
+            case OPT_JSON: config.jsonFile = optarg; break;
+            case OPT_RESULT_NAME: config.resultName = optarg; break;
+            case OPT_FMAX: config.fmax = strtod(optarg, NULL); break;
+            case OPT_BASELINE: config.baselineFile = optarg; break;
+            case OPT_REGRESSION_THRESHOLD: config.regressionThreshold = strtod(optarg, NULL); break;
+            case OPT_ACCESS_SWEEP: config.mode = MODE_ACCESS; break;
+            case OPT_READ_WRITE: config.mode = MODE_READ_WRITE; break;
+            case OPT_LAUNCH_LATENCY: config.mode = MODE_LAUNCH; break;
+            case OPT_LAUNCHES: config.launches = strtoul(optarg, NULL, 10); break;
+            case OPT_CHAINED: config.mode = MODE_CHAINED; break;
+            case OPT_MEMORY_LATENCY: config.mode = MODE_LATENCY; break;
+            case OPT_OFFSET_SWEEP: config.mode = MODE_OFFSET_SWEEP; break;
+            case OPT_INDEX_BITS: config.indexBits = strtoul(optarg, NULL, 10); break;
+            case OPT_SKIP_REPROGRAM: config.skipReprogram = true; break;
+            case OPT_DDR_SPEED: config.ddrSpeed = strtod(optarg, NULL); break;
+            case OPT_MAX_STRIDE: config.maxStride = strtoul(optarg, NULL, 10); break;
+            case OPT_EXPLORE_BANKS: config.mode = MODE_BANK_EXPLORATION; break;
+            case OPT_NUM_BANKS: config.numBanks = strtoul(optarg, NULL, 10); break;
+            case OPT_CHANNELS: config.channelKernels = true; break;
+            case OPT_TYPE: config.elementType = optarg; break;
+            case OPT_VECTOR_WIDTH: config.vectorWidth = strtoul(optarg, NULL, 10); break;
+            case OPT_PARTITIONS:
+                config.mode = MODE_PARTITION;
+                config.partitions = strtoul(optarg, NULL, 10);
+                break;
+            case OPT_BANKS:
+                if (!parseBanks(optarg)) {
+                    std::cerr << "Invalid bank placement: " << optarg << std::endl;
+                    return false;
+                }
+                break;
+            case OPT_CPU_ISA: {
+                int isa = 0;
+                while (isa < NUM_CPU_ISAS && std::string(optarg) != cpuISANames[isa]) {
+                    isa++;
+                }
+                if (isa == NUM_CPU_ISAS) {
+                    std::cerr << "Unknown instruction set: " << optarg << std::endl;
+                    return false;
+                }
+                config.cpuISA = (CpuISA) isa;
+                break;
+            }
+            case OPT_TRANSFERS:
+                config.mode = MODE_TRANSFER;
+                if (!parseTransferStrategies(optarg)) {
+                    std::cerr << "Unknown transfer strategy in: " << optarg << std::endl;
+                    return false;
+                }
+                break;
+            case 'h': printUsage(argv[0]); return false;
+            default: printUsage(argv[0]); return false;
+        }
+    }
+    if (optind < argc) {
+        std::cout << "Using kernel given as argument" << std::endl;
+        config.kernelFile = argv[optind];
+    }
+
+    if (config.ntimes < 2) {
+        std::cerr << "NTIMES has to be at least 2!" << std::endl;
+        return false;
+    }
+    if (config.warmup >= config.ntimes) {
+        std::cerr << "NTIMES has to be larger than the number of warm-up iterations!" << std::endl;
+        return false;
+    }
+    if (config.adaptive && (config.ciTarget <= 0.0 || config.timeBudget <= 0.0)) {
+        std::cerr << "Adaptive mode needs a confidence interval target and a time budget larger than 0!" << std::endl;
+        return false;
+    }
+    if (!config.autoArraySize && config.arraySize == 0) {
+        std::cerr << "Array size has to be larger than 0!" << std::endl;
+        return false;
+    }
+    if (config.mode == MODE_SWEEP && config.sweepFactor <= 1.0) {
+        std::cerr << "Sweep needs a factor larger than 1!" << std::endl;
+        return false;
+    }
+    if (config.mode == MODE_PIPELINE && (config.chunkSize == 0 || config.chunkBuffers < 2)) {
+        std::cerr << "Pipeline needs a chunk size larger than 0 and at least 2 buffer sets!" << std::endl;
+        return false;
+    }
+    if (config.mode == MODE_ACCESS && config.maxStride == 0) {
+        std::cerr << "The maximum stride has to be at least 1!" << std::endl;
+        return false;
+    }
+    if (config.channelKernels &&
+        (config.mode == MODE_CONCURRENT || config.mode == MODE_PIPELINE || config.mode == MODE_ACCESS ||
+         config.mode == MODE_PARTITION || config.mode == MODE_READ_WRITE || config.mode == MODE_LAUNCH ||
+         config.mode == MODE_LATENCY)) {
+        std::cerr << "The channel kernels can not be used with the concurrent, pipeline, access, partition, read-write"
+                  << " and latency modes!"
+                  << std::endl;
+        return false;
+    }
+    if (config.ddrSpeed <= 0.0) {
+        std::cerr << "The DDR speed has to be larger than 0!" << std::endl;
+        return false;
+    }
+    if (config.mode == MODE_LAUNCH && config.launches < 2) {
+        std::cerr << "The launch latency mode needs at least 2 launches!" << std::endl;
+        return false;
+    }
+    if (config.mode == MODE_PARTITION && config.partitions == 0) {
+        std::cerr << "The number of partitions has to be at least 1!" << std::endl;
+        return false;
+    }
+    if (config.numBanks < 1 || config.numBanks > 4) {
+        std::cerr << "The number of banks has to be between 1 and 4!" << std::endl;
+        return false;
+    }
+    for (int i=0; i<3; i++) {
+        if (config.banks[i] > config.numBanks) {
+            std::cerr << "Bank " << config.banks[i] << " exceeds the number of banks!" << std::endl;
+            return false;
+        }
+    }
+    if (config.mode == MODE_CPU && config.autoArraySize) {
+        std::cerr << "The array size can not be chosen automatically without a device!" << std::endl;
+        return false;
+    }
+    if (config.alignment < sizeof(void*) || (config.alignment & (config.alignment - 1)) != 0) {
+        std::cerr << "Alignment has to be a power of two and at least " << sizeof(void*) << " bytes!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+*  Parse a comma separated list of transfer strategies into
+*  config.transferStrategies. Returns false for unknown names.
+*-----------------------------------------------------------------------*/
+bool parseTransferStrategies(const char * list)
+{
+    std::string names(list);
+    config.transferStrategies = 0;
+    size_t start = 0;
+    while (start <= names.size()) {
+        size_t end = names.find(',', start);
+        if (end == std::string::npos) {
+            end = names.size();
+        }
+        std::string name = names.substr(start, end - start);
+        if (name == "all") {
+            config.transferStrategies = (1 << NUM_TRANSFER_STRATEGIES) - 1;
+        }
+        else {
+            int s = 0;
+            while (s < NUM_TRANSFER_STRATEGIES && name != transferNames[s]) {
+                s++;
+            }
+            if (s == NUM_TRANSFER_STRATEGIES) {
+                return false;
+            }
+            config.transferStrategies |= 1 << s;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+/*
+*  Allocate an array on the heap that is aligned to config.alignment bytes
+*  or the given alignment.
+*  Returns NULL if the allocation failed. Free the array with free().
+*-----------------------------------------------------------------------*/
+template<typename T>
+T* allocateHostArray(size_t elements)
+{
+    return allocateAlignedArray<T>(elements, config.alignment);
+}
+
+template<typename T>
+T* allocateAlignedArray(size_t elements, size_t alignment)
+{
+    void * ptr = NULL;
+    if (posix_memalign(&ptr, alignment, sizeof(T) * elements) != 0) {
+        return NULL;
+    }
+    return (T*) ptr;
+}
 
 # define	M	20
 
@@ -559,32 +5211,39 @@ checktick()
 
 
 
-/* A gettimeofday routine to give access to the wall
-   clock timer on most UNIX-like systems.  */
-
-#include <sys/time.h>
+/* A clock_gettime routine to give access to a monotonic
+   wall clock timer with nanosecond resolution on POSIX systems.
+   gettimeofday is limited to microseconds, which is too coarse for the
+   end-to-end times of small arrays.  */
 
 double mysecond()
 {
-        struct timeval tp;
-        struct timezone tzp;
-        int i;
+        struct timespec tp;
 
-        i = gettimeofday(&tp,&tzp);
-        return ( (double) tp.tv_sec + (double) tp.tv_usec * 1.e-6 );
+        clock_gettime(CLOCK_MONOTONIC, &tp);
+        return ( (double) tp.tv_sec + (double) tp.tv_nsec * 1.e-9 );
 }
 
 #ifndef abs
 #define abs(a) ((a) >= 0 ? (a) : -(a))
 #endif
-void checkSTREAMresults ()
+/*
+*  Validate the first array_size elements of the arrays A, B and C.
+*  Returns the number of arrays that failed the validation. If quiet is set,
+*  nothing is printed for a successful validation.
+*-----------------------------------------------------------------------*/
+template<typename T>
+int checkSTREAMresults (const T* A, const T* B, const T* C,
+                        size_t array_size, bool quiet)
 {
-    STREAM_TYPE aj,bj,cj,scalar;
-    STREAM_TYPE aSumErr,bSumErr,cSumErr;
-    STREAM_TYPE aAvgErr,bAvgErr,cAvgErr;
-    double epsilon;
+    T aj,bj,cj,scalar;
+    T aSumErr,bSumErr,cSumErr;
+    double aAvgErr,bAvgErr,cAvgErr;
+    double epsilon, threshold;
     ssize_t	j;
-    int	k,ierr,err;
+    unsigned	k;
+    ssize_t	ierr;
+    int	err;
 
     /* reproduce initialization */
     aj = 1.0;
@@ -594,7 +5253,7 @@ void checkSTREAMresults ()
     aj = 2.0E0 * aj;
     /* now execute timing loop */
     scalar = 3.0;
-    for (k=0; k<NTIMES; k++)
+    for (k=0; k<config.ntimes; k++)
         {
             cj = aj;
             bj = scalar*cj;
@@ -603,94 +5262,107 @@ void checkSTREAMresults ()
         }
 
     /* accumulate deltas between observed and expected results */
-    aSumErr = 0.0;
-    bSumErr = 0.0;
-    cSumErr = 0.0;
-    for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-    aSumErr += abs(A[j] - aj);
-    bSumErr += abs(B[j] - bj);
-    cSumErr += abs(C[j] - cj);
-    // if (j == 417) printf("Index 417: c[j]: %f, cj: %f\n",c[j],cj);	// MCCALPIN
-    }
-    aAvgErr = aSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
-    bAvgErr = bSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
-    cAvgErr = cSumErr / (STREAM_TYPE) STREAM_ARRAY_SIZE;
-
-    if (sizeof(STREAM_TYPE) == 4) {
+    /* in a single parallel pass over all three arrays */
+    T expected[3] = {aj, bj, cj};
+    T sumErr[3];
+    errorSums(A, B, C, expected, array_size, sumErr);
+    aSumErr = sumErr[0];
+    bSumErr = sumErr[1];
+    cSumErr = sumErr[2];
+    aAvgErr = (double) aSumErr / array_size;
+    bAvgErr = (double) bSumErr / array_size;
+    cAvgErr = (double) cSumErr / array_size;
+
+    if (std::numeric_limits<T>::is_integer) {
+    /* integer results have to be exact */
+    epsilon = 0.0;
+    }
+    else if (sizeof(T) == 2) {
+    epsilon = 1.e-3;
+    }
+    else if (sizeof(T) == 4) {
     epsilon = 1.e-6;
     }
-    else if (sizeof(STREAM_TYPE) == 8) {
+    else if (sizeof(T) == 8) {
     epsilon = 1.e-13;
     }
     else {
-    printf("WEIRD: sizeof(STREAM_TYPE) = %lu\n",sizeof(STREAM_TYPE));
+    printf("WEIRD: sizeof(T) = %lu\n",sizeof(T));
     epsilon = 1.e-6;
     }
 
     err = 0;
-    if (abs(aAvgErr/aj) > epsilon) {
+    if (abs(aAvgErr/(double) aj) > epsilon) {
     err++;
     printf ("Failed Validation on array a[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-    printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",aj,aAvgErr,abs(aAvgErr)/aj);
+    printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",(double) aj,aAvgErr,abs(aAvgErr)/(double) aj);
+    /* compare the absolute error to avoid a division for every element */
+    threshold = epsilon * abs((double) aj);
     ierr = 0;
-    for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-    if (abs(A[j]/aj-1.0) > epsilon) {
+    for (j=0; j<(ssize_t) array_size; j++) {
+    if (abs((double) A[j]-(double) aj) > threshold) {
     ierr++;
 #ifdef VERBOSE
     if (ierr < 10) {
     printf("         array a: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-    j,aj,A[j],abs((aj-A[j])/aAvgErr));
+    j,(double) aj,(double) A[j],abs(((double) aj-(double) A[j])/aAvgErr));
     }
 #endif
     }
     }
-    printf("     For array a[], %d errors were found.\n",ierr);
+    printf("     For array a[], %ld errors were found.\n",(long) ierr);
     }
-    if (abs(bAvgErr/bj) > epsilon) {
+    if (abs(bAvgErr/(double) bj) > epsilon) {
     err++;
     printf ("Failed Validation on array b[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-    printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",bj,bAvgErr,abs(bAvgErr)/bj);
+    printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",(double) bj,bAvgErr,abs(bAvgErr)/(double) bj);
+    /* compare the absolute error to avoid a division for every element */
+    threshold = epsilon * abs((double) bj);
     printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
     ierr = 0;
-    for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-    if (abs(B[j]/bj-1.0) > epsilon) {
+    for (j=0; j<(ssize_t) array_size; j++) {
+    if (abs((double) B[j]-(double) bj) > threshold) {
     ierr++;
 #ifdef VERBOSE
     if (ierr < 10) {
     printf("         array b: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-    j,bj,B[j],abs((bj-B[j])/bAvgErr));
+    j,(double) bj,(double) B[j],abs(((double) bj-(double) B[j])/bAvgErr));
     }
 #endif
     }
     }
-    printf("     For array b[], %d errors were found.\n",ierr);
+    printf("     For array b[], %ld errors were found.\n",(long) ierr);
     }
-    if (abs(cAvgErr/cj) > epsilon) {
+    if (abs(cAvgErr/(double) cj) > epsilon) {
     err++;
     printf ("Failed Validation on array c[], AvgRelAbsErr > epsilon (%e)\n",epsilon);
-    printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",cj,cAvgErr,abs(cAvgErr)/cj);
+    printf ("     Expected Value: %e, AvgAbsErr: %e, AvgRelAbsErr: %e\n",(double) cj,cAvgErr,abs(cAvgErr)/(double) cj);
+    /* compare the absolute error to avoid a division for every element */
+    threshold = epsilon * abs((double) cj);
     printf ("     AvgRelAbsErr > Epsilon (%e)\n",epsilon);
     ierr = 0;
-    for (j=0; j<STREAM_ARRAY_SIZE; j++) {
-    if (abs(C[j]/cj-1.0) > epsilon) {
+    for (j=0; j<(ssize_t) array_size; j++) {
+    if (abs((double) C[j]-(double) cj) > threshold) {
     ierr++;
 #ifdef VERBOSE
     if (ierr < 10) {
     printf("         array c: index: %ld, expected: %e, observed: %e, relative error: %e\n",
-    j,cj,C[j],abs((cj-C[j])/cAvgErr));
+    j,(double) cj,(double) C[j],abs(((double) cj-(double) C[j])/cAvgErr));
     }
 #endif
     }
     }
-    printf("     For array c[], %d errors were found.\n",ierr);
+    printf("     For array c[], %ld errors were found.\n",(long) ierr);
     }
-    if (err == 0) {
+    if (err == 0 && !quiet) {
     printf ("Solution Validates: avg error less than %e on all three arrays\n",epsilon);
     }
 #ifdef VERBOSE
     printf ("Results Validation Verbose Results: \n");
-    printf ("    Expected a(1), b(1), c(1): %f %f %f \n",aj,bj,cj);
-    printf ("    Observed a(1), b(1), c(1): %f %f %f \n",A[1],B[1],C[1]);
+    printf ("    Expected a(1), b(1), c(1): %f %f %f \n",(double) aj,(double) bj,(double) cj);
+    printf ("    Observed a(1), b(1), c(1): %f %f %f \n",(double) A[1],(double) B[1],(double) C[1]);
     printf ("    Rel Errors on a, b, c:     %e %e %e \n",abs(aAvgErr/aj),abs(bAvgErr/bj),abs(cAvgErr/cj));
 #endif
+    return err;
 }
+#undef abs
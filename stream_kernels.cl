@@ -1,11 +1,21 @@
 /*
 STREAM kernels using scalar types and unrolling.
+
+The STREAM kernels process array_size elements starting at the element
+offset of the buffers, so also unaligned accesses can be measured.
+With INDEX_TILED, the 64 bit array sizes are processed in tiles of at most
+INDEX_TILE_SIZE elements. So the pipelined loops keep a 32 bit counter and
+exit condition, which may allow a higher fMax than 64 bit loop counters.
 */
 
 #if (QUARTUS_MAJOR_VERSION <= 18)
 #pragma OPENCL EXTENSION cl_khr_fp64 : enable
 #endif
 
+#ifdef STREAM_TYPE_FP16
+#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+#endif
+
 #ifndef STREAM_TYPE
 #define STREAM_TYPE double
 #endif
@@ -14,39 +24,102 @@ STREAM kernels using scalar types and unrolling.
 #define UNROLL_COUNT 8
 #endif
 
+// Type of the array size and offset of the STREAM kernels. With INDEX_BITS=64
+// the arrays can have more than 4G elements.
+#if defined(INDEX_BITS) && (INDEX_BITS == 64)
+#define INDEX_TYPE ulong
+#else
+#define INDEX_TYPE uint
+#endif
+
+#ifdef INDEX_TILED
+#if !defined(INDEX_BITS) || (INDEX_BITS != 64)
+#error "INDEX_TILED needs INDEX_BITS=64"
+#endif
+#ifndef INDEX_TILE_SIZE
+#define INDEX_TILE_SIZE (1u << 30)
+#endif
+#endif
+
+#ifndef READ_WRITE_RATIO
+#define READ_WRITE_RATIO 4
+#endif
+
+// Latency of the floating point addition in clock cycles. The sum kernel
+// keeps this many partial sums, so the accumulation does not limit the II.
+#ifndef SUM_LATENCY
+#define SUM_LATENCY 8
+#endif
+
 __kernel
 void copy(__global const STREAM_TYPE * restrict in,
           __global STREAM_TYPE * restrict out,
-          uint array_size) {
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
 
+#ifdef INDEX_TILED
+    for (INDEX_TYPE tile=0; tile<array_size; tile+=INDEX_TILE_SIZE){
+        INDEX_TYPE base = offset + tile;
+        uint tile_size = (uint) min(array_size - tile, (INDEX_TYPE) INDEX_TILE_SIZE);
+        #pragma unroll UNROLL_COUNT
+        for (uint i=0; i<tile_size; i++){
+            out[base + i] = in[base + i];
+        }
+    }
+#else
     #pragma unroll UNROLL_COUNT
-    for(uint i = 0; i < array_size; i++){
-        out[i] = in[i];
+    for(INDEX_TYPE i = 0; i < array_size; i++){
+        out[offset + i] = in[offset + i];
     }
+#endif
 }
 
 __kernel
 void add(__global const STREAM_TYPE * restrict in1,
           __global const STREAM_TYPE * restrict in2,
           __global STREAM_TYPE * restrict out,
-          uint array_size) {
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
 
+#ifdef INDEX_TILED
+    for (INDEX_TYPE tile=0; tile<array_size; tile+=INDEX_TILE_SIZE){
+        INDEX_TYPE base = offset + tile;
+        uint tile_size = (uint) min(array_size - tile, (INDEX_TYPE) INDEX_TILE_SIZE);
+        #pragma unroll UNROLL_COUNT
+        for (uint i=0; i<tile_size; i++){
+            out[base + i] = in1[base + i] + in2[base + i];
+        }
+    }
+#else
     #pragma unroll UNROLL_COUNT
-    for (uint i=0; i<array_size; i++){
-        out[i] = in1[i] + in2[i];
+    for (INDEX_TYPE i=0; i<array_size; i++){
+        out[offset + i] = in1[offset + i] + in2[offset + i];
     }
+#endif
 }
 
 __kernel
 void scale(__global const STREAM_TYPE * restrict in,
           __global STREAM_TYPE * restrict out,
           STREAM_TYPE scalar,
-          uint array_size) {
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
 
+#ifdef INDEX_TILED
+    for (INDEX_TYPE tile=0; tile<array_size; tile+=INDEX_TILE_SIZE){
+        INDEX_TYPE base = offset + tile;
+        uint tile_size = (uint) min(array_size - tile, (INDEX_TYPE) INDEX_TILE_SIZE);
+        #pragma unroll UNROLL_COUNT
+        for (uint i=0; i<tile_size; i++){
+            out[base + i] = scalar * in[base + i];
+        }
+    }
+#else
     #pragma unroll UNROLL_COUNT
-    for (uint i=0; i<array_size; i++){
-        out[i] = scalar * in[i];
+    for (INDEX_TYPE i=0; i<array_size; i++){
+        out[offset + i] = scalar * in[offset + i];
     }
+#endif
 }
 
 __kernel
@@ -54,10 +127,122 @@ void triad(__global const STREAM_TYPE * restrict in1,
           __global const STREAM_TYPE * restrict in2,
           __global STREAM_TYPE * restrict out,
           STREAM_TYPE scalar,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+#ifdef INDEX_TILED
+    for (INDEX_TYPE tile=0; tile<array_size; tile+=INDEX_TILE_SIZE){
+        INDEX_TYPE base = offset + tile;
+        uint tile_size = (uint) min(array_size - tile, (INDEX_TYPE) INDEX_TILE_SIZE);
+        #pragma unroll UNROLL_COUNT
+        for (uint i=0; i<tile_size; i++){
+            out[base + i] = in1[base + i] + scalar * in2[base + i];
+        }
+    }
+#else
+    #pragma unroll UNROLL_COUNT
+    for (INDEX_TYPE i=0; i<array_size; i++){
+        out[offset + i] = in1[offset + i] + scalar * in2[offset + i];
+    }
+#endif
+}
+
+/*
+The following kernels only read or only write global memory or use an
+asymmetric ratio of reads and writes, so the read and write bandwidth can be
+measured separately.
+*/
+
+__kernel
+void fill(__global STREAM_TYPE * restrict out,
+          STREAM_TYPE value,
           uint array_size) {
-    
+
     #pragma unroll UNROLL_COUNT
     for (uint i=0; i<array_size; i++){
-        out[i] = in1[i] + scalar * in2[i];
+        out[i] = value;
     }
-}
\ No newline at end of file
+}
+
+__kernel
+void sum(__global const STREAM_TYPE * restrict in,
+          __global STREAM_TYPE * restrict result,
+          uint array_size) {
+
+    STREAM_TYPE partial[SUM_LATENCY + 1];
+    #pragma unroll
+    for (uint j=0; j<SUM_LATENCY + 1; j++){
+        partial[j] = 0;
+    }
+
+    uint blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (uint b=0; b<blocks; b++){
+        STREAM_TYPE block_sum = 0;
+        #pragma unroll
+        for (uint u=0; u<UNROLL_COUNT; u++){
+            uint i = b * UNROLL_COUNT + u;
+            block_sum += (i < array_size) ? in[i] : 0;
+        }
+        // shift register, so every partial sum is updated every SUM_LATENCY cycles
+        partial[SUM_LATENCY] = partial[0] + block_sum;
+        #pragma unroll
+        for (uint j=0; j<SUM_LATENCY; j++){
+            partial[j] = partial[j + 1];
+        }
+    }
+
+    STREAM_TYPE total = 0;
+    #pragma unroll
+    for (uint j=0; j<SUM_LATENCY; j++){
+        total += partial[j];
+    }
+    result[0] = total;
+}
+
+/*
+Reads READ_WRITE_RATIO elements for every written element. The input array
+is split into READ_WRITE_RATIO parts that are added element-wise.
+*/
+__kernel
+void read_ratio(__global const STREAM_TYPE * restrict in,
+          __global STREAM_TYPE * restrict out,
+          uint array_size) {
+
+    uint count = array_size / READ_WRITE_RATIO;
+    #pragma unroll UNROLL_COUNT
+    for (uint i=0; i<count; i++){
+        STREAM_TYPE value = 0;
+        #pragma unroll
+        for (uint r=0; r<READ_WRITE_RATIO; r++){
+            value += in[r * count + i];
+        }
+        out[i] = value;
+    }
+}
+
+/*
+Writes READ_WRITE_RATIO elements for every read element. Every element of
+the input is copied to all READ_WRITE_RATIO parts of the output array.
+*/
+__kernel
+void write_ratio(__global const STREAM_TYPE * restrict in,
+          __global STREAM_TYPE * restrict out,
+          uint array_size) {
+
+    uint count = array_size / READ_WRITE_RATIO;
+    #pragma unroll UNROLL_COUNT
+    for (uint i=0; i<count; i++){
+        STREAM_TYPE value = in[i];
+        #pragma unroll
+        for (uint r=0; r<READ_WRITE_RATIO; r++){
+            out[r * count + i] = value;
+        }
+    }
+}
+
+/*
+Kernel without any work to measure the launch overhead.
+*/
+__kernel
+void empty() {
+}
@@ -0,0 +1,84 @@
+/*
+Kernels with strided and indexed memory accesses.
+
+The strided kernels access only every stride-th element of the arrays and
+the gather and scatter kernels access the arrays indirectly over an index
+array. In contrast to the sequential STREAM kernels, the load store units
+can not combine these accesses to ideal bursts.
+The STREAM kernels are included, so the host can use this file like the
+other kernel files.
+*/
+
+#include "stream_kernels.cl"
+
+__kernel
+void strided_copy(__global const STREAM_TYPE * restrict in,
+          __global STREAM_TYPE * restrict out,
+          uint stride,
+          uint array_size) {
+
+    uint count = array_size / stride;
+    #pragma unroll UNROLL_COUNT
+    for (uint i=0; i<count; i++){
+        out[i * stride] = in[i * stride];
+    }
+}
+
+__kernel
+void strided_triad(__global const STREAM_TYPE * restrict in1,
+          __global const STREAM_TYPE * restrict in2,
+          __global STREAM_TYPE * restrict out,
+          STREAM_TYPE scalar,
+          uint stride,
+          uint array_size) {
+
+    uint count = array_size / stride;
+    #pragma unroll UNROLL_COUNT
+    for (uint i=0; i<count; i++){
+        out[i * stride] = in1[i * stride] + scalar * in2[i * stride];
+    }
+}
+
+__kernel
+void gather(__global const STREAM_TYPE * restrict in,
+          __global const uint * restrict idx,
+          __global STREAM_TYPE * restrict out,
+          uint array_size) {
+
+    #pragma unroll UNROLL_COUNT
+    for (uint i=0; i<array_size; i++){
+        out[i] = in[idx[i]];
+    }
+}
+
+__kernel
+void scatter(__global const STREAM_TYPE * restrict in,
+          __global const uint * restrict idx,
+          __global STREAM_TYPE * restrict out,
+          uint array_size) {
+
+    #pragma unroll UNROLL_COUNT
+    for (uint i=0; i<array_size; i++){
+        out[idx[i]] = in[i];
+    }
+}
+
+/*
+Follows a chain of indices for the given number of loads, where every
+element contains the index of the next element. Every load depends on the
+previous one, so the time per load is the latency of the global memory.
+volatile prevents the compiler from adding a cache to the load store unit.
+The last index is returned, so the host can validate the walk.
+*/
+__kernel
+void pointer_chase(__global volatile const uint * restrict next,
+          __global uint * restrict result,
+          uint start,
+          uint loads) {
+
+    uint index = start;
+    for (uint i=0; i<loads; i++){
+        index = next[index];
+    }
+    result[0] = index;
+}
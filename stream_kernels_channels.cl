@@ -0,0 +1,245 @@
+/*
+STREAM kernels that are split into reader, compute and writer kernels.
+
+Every STREAM operation is executed by a group of three kernels that are
+connected by channels: the reader only loads from global memory, the
+compute kernel only calculates and the writer only stores to global memory.
+So the compiler can schedule the load and store units independently of
+each other. The host has to start all kernels of a group at the same time.
+The channels transfer blocks of UNROLL_COUNT elements.
+*/
+
+#pragma OPENCL EXTENSION cl_intel_channels : enable
+
+#if (QUARTUS_MAJOR_VERSION <= 18)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#ifdef STREAM_TYPE_FP16
+#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+#endif
+
+#ifndef STREAM_TYPE
+#define STREAM_TYPE double
+#endif
+
+#ifndef UNROLL_COUNT
+#define UNROLL_COUNT 8
+#endif
+
+#ifndef CHANNEL_DEPTH
+#define CHANNEL_DEPTH 64
+#endif
+
+// Type of the array size and offset of the STREAM kernels. With INDEX_BITS=64
+// the arrays can have more than 4G elements.
+#if defined(INDEX_BITS) && (INDEX_BITS == 64)
+#define INDEX_TYPE ulong
+#else
+#define INDEX_TYPE uint
+#endif
+
+#ifdef INDEX_TILED
+#error "INDEX_TILED is only supported by stream_kernels.cl"
+#endif
+
+typedef struct {
+    STREAM_TYPE values[UNROLL_COUNT];
+} stream_block;
+
+channel stream_block copy_in __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block copy_out __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block scale_in __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block scale_out __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block add_in1 __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block add_in2 __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block add_out __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block triad_in1 __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block triad_in2 __attribute__((depth(CHANNEL_DEPTH)));
+channel stream_block triad_out __attribute__((depth(CHANNEL_DEPTH)));
+
+/*
+Load the block b of an array that starts at the element offset. Elements
+behind the end of the array are set to zero.
+*/
+stream_block load_block(__global const STREAM_TYPE * restrict in,
+          INDEX_TYPE b,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    stream_block block;
+    #pragma unroll
+    for (uint u=0; u<UNROLL_COUNT; u++){
+        INDEX_TYPE i = b * UNROLL_COUNT + u;
+        block.values[u] = (i < array_size) ? in[offset + i] : 0;
+    }
+    return block;
+}
+
+/*
+Store the block b of an array that starts at the element offset without
+the elements behind the end of the array.
+*/
+void store_block(__global STREAM_TYPE * restrict out,
+          stream_block block,
+          INDEX_TYPE b,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    #pragma unroll
+    for (uint u=0; u<UNROLL_COUNT; u++){
+        INDEX_TYPE i = b * UNROLL_COUNT + u;
+        if (i < array_size) {
+            out[offset + i] = block.values[u];
+        }
+    }
+}
+
+__kernel
+void copy_read(__global const STREAM_TYPE * restrict in,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        write_channel_intel(copy_in, load_block(in, b, array_size, offset));
+    }
+}
+
+__kernel
+void copy_compute(INDEX_TYPE array_size) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        write_channel_intel(copy_out, read_channel_intel(copy_in));
+    }
+}
+
+__kernel
+void copy_write(__global STREAM_TYPE * restrict out,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        store_block(out, read_channel_intel(copy_out), b, array_size, offset);
+    }
+}
+
+__kernel
+void scale_read(__global const STREAM_TYPE * restrict in,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        write_channel_intel(scale_in, load_block(in, b, array_size, offset));
+    }
+}
+
+__kernel
+void scale_compute(STREAM_TYPE scalar,
+          INDEX_TYPE array_size) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        stream_block block = read_channel_intel(scale_in);
+        #pragma unroll
+        for (uint u=0; u<UNROLL_COUNT; u++){
+            block.values[u] = scalar * block.values[u];
+        }
+        write_channel_intel(scale_out, block);
+    }
+}
+
+__kernel
+void scale_write(__global STREAM_TYPE * restrict out,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        store_block(out, read_channel_intel(scale_out), b, array_size, offset);
+    }
+}
+
+__kernel
+void add_read(__global const STREAM_TYPE * restrict in1,
+          __global const STREAM_TYPE * restrict in2,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        write_channel_intel(add_in1, load_block(in1, b, array_size, offset));
+        write_channel_intel(add_in2, load_block(in2, b, array_size, offset));
+    }
+}
+
+__kernel
+void add_compute(INDEX_TYPE array_size) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        stream_block block1 = read_channel_intel(add_in1);
+        stream_block block2 = read_channel_intel(add_in2);
+        stream_block result;
+        #pragma unroll
+        for (uint u=0; u<UNROLL_COUNT; u++){
+            result.values[u] = block1.values[u] + block2.values[u];
+        }
+        write_channel_intel(add_out, result);
+    }
+}
+
+__kernel
+void add_write(__global STREAM_TYPE * restrict out,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        store_block(out, read_channel_intel(add_out), b, array_size, offset);
+    }
+}
+
+__kernel
+void triad_read(__global const STREAM_TYPE * restrict in1,
+          __global const STREAM_TYPE * restrict in2,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        write_channel_intel(triad_in1, load_block(in1, b, array_size, offset));
+        write_channel_intel(triad_in2, load_block(in2, b, array_size, offset));
+    }
+}
+
+__kernel
+void triad_compute(STREAM_TYPE scalar,
+          INDEX_TYPE array_size) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        stream_block block1 = read_channel_intel(triad_in1);
+        stream_block block2 = read_channel_intel(triad_in2);
+        stream_block result;
+        #pragma unroll
+        for (uint u=0; u<UNROLL_COUNT; u++){
+            result.values[u] = block1.values[u] + scalar * block2.values[u];
+        }
+        write_channel_intel(triad_out, result);
+    }
+}
+
+__kernel
+void triad_write(__global STREAM_TYPE * restrict out,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE blocks = (array_size + UNROLL_COUNT - 1) / UNROLL_COUNT;
+    for (INDEX_TYPE b=0; b<blocks; b++){
+        store_block(out, read_channel_intel(triad_out), b, array_size, offset);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+STREAM kernels using scalar types and unrolling, which are replicated
+NUM_COMPUTE_UNITS times.
+
+The host splits the arrays into partitions and starts the kernels for all
+partitions at the same time, so every partition is processed by its own
+compute unit with its own load and store units.
+*/
+
+#if (QUARTUS_MAJOR_VERSION <= 18)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#endif
+
+#ifdef STREAM_TYPE_FP16
+#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+#endif
+
+#ifndef STREAM_TYPE
+#define STREAM_TYPE double
+#endif
+
+#ifndef UNROLL_COUNT
+#define UNROLL_COUNT 8
+#endif
+
+// Type of the array size and offset of the STREAM kernels. With INDEX_BITS=64
+// the arrays can have more than 4G elements.
+#if defined(INDEX_BITS) && (INDEX_BITS == 64)
+#define INDEX_TYPE ulong
+#else
+#define INDEX_TYPE uint
+#endif
+
+#ifdef INDEX_TILED
+#error "INDEX_TILED is only supported by stream_kernels.cl"
+#endif
+
+#ifndef NUM_COMPUTE_UNITS
+#define NUM_COMPUTE_UNITS 4
+#endif
+
+__attribute__((max_global_work_dim(0)))
+__attribute__((num_compute_units(NUM_COMPUTE_UNITS)))
+__kernel
+void copy(__global const STREAM_TYPE * restrict in,
+          __global STREAM_TYPE * restrict out,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    #pragma unroll UNROLL_COUNT
+    for(INDEX_TYPE i = 0; i < array_size; i++){
+        out[offset + i] = in[offset + i];
+    }
+}
+
+__attribute__((max_global_work_dim(0)))
+__attribute__((num_compute_units(NUM_COMPUTE_UNITS)))
+__kernel
+void add(__global const STREAM_TYPE * restrict in1,
+          __global const STREAM_TYPE * restrict in2,
+          __global STREAM_TYPE * restrict out,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    #pragma unroll UNROLL_COUNT
+    for (INDEX_TYPE i=0; i<array_size; i++){
+        out[offset + i] = in1[offset + i] + in2[offset + i];
+    }
+}
+
+__attribute__((max_global_work_dim(0)))
+__attribute__((num_compute_units(NUM_COMPUTE_UNITS)))
+__kernel
+void scale(__global const STREAM_TYPE * restrict in,
+          __global STREAM_TYPE * restrict out,
+          STREAM_TYPE scalar,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    #pragma unroll UNROLL_COUNT
+    for (INDEX_TYPE i=0; i<array_size; i++){
+        out[offset + i] = scalar * in[offset + i];
+    }
+}
+
+__attribute__((max_global_work_dim(0)))
+__attribute__((num_compute_units(NUM_COMPUTE_UNITS)))
+__kernel
+void triad(__global const STREAM_TYPE * restrict in1,
+          __global const STREAM_TYPE * restrict in2,
+          __global STREAM_TYPE * restrict out,
+          STREAM_TYPE scalar,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    #pragma unroll UNROLL_COUNT
+    for (INDEX_TYPE i=0; i<array_size; i++){
+        out[offset + i] = in1[offset + i] + scalar * in2[offset + i];
+    }
+}
@@ -3,6 +3,8 @@ Kernel implementations for the STRAM benchmark which utilize vector types
 instead of the unroll pragma.
 
  Also manual unrolling is done in the copy and scalar kernel.
+ The STREAM kernels start at the element offset of the buffers, which has
+ to be a multiple of UNROLL_COUNT.
  */
 
 
@@ -10,6 +12,10 @@ instead of the unroll pragma.
 #pragma OPENCL EXTENSION cl_khr_fp64 : enable
 #endif
 
+#ifdef STREAM_TYPE_FP16
+#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+#endif
+
 #ifndef STREAM_TYPE
 #define STREAM_TYPE double
 #endif
@@ -18,6 +24,26 @@ instead of the unroll pragma.
 #define UNROLL_COUNT 8
 #endif
 
+// Type of the array size and offset of the STREAM kernels. With INDEX_BITS=64
+// the arrays can have more than 4G elements.
+#if defined(INDEX_BITS) && (INDEX_BITS == 64)
+#define INDEX_TYPE ulong
+#else
+#define INDEX_TYPE uint
+#endif
+
+#ifdef INDEX_TILED
+#error "INDEX_TILED is only supported by stream_kernels.cl"
+#endif
+
+#ifndef READ_WRITE_RATIO
+#define READ_WRITE_RATIO 4
+#endif
+
+#ifndef SUM_LATENCY
+#define SUM_LATENCY 8
+#endif
+
 
 #define PASTER(x,y) x ## y
 #define EVALUATOR(x,y) PASTER(x,y)
@@ -27,13 +53,15 @@ instead of the unroll pragma.
 __kernel
 void copy(__global const VEC_TYPE * restrict in,
           __global VEC_TYPE * restrict out,
-          uint array_size) {
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
 
-    uint vector_size = array_size/(UNROLL_COUNT*2);
+    INDEX_TYPE vector_size = array_size/(UNROLL_COUNT*2);
+    INDEX_TYPE vector_offset = offset/UNROLL_COUNT;
     #pragma ivdep
-    for(uint i = 0; i < vector_size; i++){
-        out[i] = in[i];
-        out[vector_size+i] = in[vector_size+i];
+    for(INDEX_TYPE i = 0; i < vector_size; i++){
+        out[vector_offset+i] = in[vector_offset+i];
+        out[vector_offset+vector_size+i] = in[vector_offset+vector_size+i];
     }
 }
 
@@ -41,11 +69,13 @@ __kernel
 void add(__global const VEC_TYPE * restrict in1,
           __global const VEC_TYPE * restrict in2,
           __global VEC_TYPE * restrict out,
-          uint array_size) {
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
 
-    uint vector_size = array_size/UNROLL_COUNT;
-    for (uint i=0; i<vector_size; i++){
-        out[i] = in1[i] + in2[i];
+    INDEX_TYPE vector_size = array_size/UNROLL_COUNT;
+    INDEX_TYPE vector_offset = offset/UNROLL_COUNT;
+    for (INDEX_TYPE i=0; i<vector_size; i++){
+        out[vector_offset+i] = in1[vector_offset+i] + in2[vector_offset+i];
     }
 }
 
@@ -53,13 +83,15 @@ __kernel
 void scale(__global const VEC_TYPE * restrict in,
           __global VEC_TYPE * restrict out,
           STREAM_TYPE scalar,
-          uint array_size) {
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
 
-    uint vector_size = array_size/(UNROLL_COUNT*2);
+    INDEX_TYPE vector_size = array_size/(UNROLL_COUNT*2);
+    INDEX_TYPE vector_offset = offset/UNROLL_COUNT;
     #pragma ivdep
-    for (uint i=0; i<vector_size; i++){
-        out[i] = scalar * in[i];
-        out[vector_size+i] = scalar * in[vector_size+i];
+    for (INDEX_TYPE i=0; i<vector_size; i++){
+        out[vector_offset+i] = scalar * in[vector_offset+i];
+        out[vector_offset+vector_size+i] = scalar * in[vector_offset+vector_size+i];
     }
 }
 
@@ -68,10 +100,105 @@ void triad(__global const VEC_TYPE * restrict in1,
           __global const VEC_TYPE * restrict in2,
           __global VEC_TYPE * restrict out,
           STREAM_TYPE scalar,
+          INDEX_TYPE array_size,
+          INDEX_TYPE offset) {
+
+    INDEX_TYPE vector_size = array_size / UNROLL_COUNT;
+    INDEX_TYPE vector_offset = offset / UNROLL_COUNT;
+    for (INDEX_TYPE i=0; i<vector_size; i++){
+        out[vector_offset+i] = in1[vector_offset+i] + scalar * in2[vector_offset+i];
+    }
+}
+
+/*
+Kernels that only read or only write global memory or use an asymmetric
+ratio of reads and writes. They process the same elements as the kernels in
+stream_kernels.cl, if the array size is a multiple of
+READ_WRITE_RATIO * UNROLL_COUNT.
+*/
+
+__kernel
+void fill(__global VEC_TYPE * restrict out,
+          STREAM_TYPE value,
           uint array_size) {
 
     uint vector_size = array_size / UNROLL_COUNT;
     for (uint i=0; i<vector_size; i++){
-        out[i] = in1[i] + scalar * in2[i];
+        out[i] = (VEC_TYPE) value;
     }
 }
+
+__kernel
+void sum(__global const VEC_TYPE * restrict in,
+          __global STREAM_TYPE * restrict result,
+          uint array_size) {
+
+    VEC_TYPE partial[SUM_LATENCY + 1];
+    #pragma unroll
+    for (uint j=0; j<SUM_LATENCY + 1; j++){
+        partial[j] = 0;
+    }
+
+    uint vector_size = array_size / UNROLL_COUNT;
+    for (uint i=0; i<vector_size; i++){
+        partial[SUM_LATENCY] = partial[0] + in[i];
+        #pragma unroll
+        for (uint j=0; j<SUM_LATENCY; j++){
+            partial[j] = partial[j + 1];
+        }
+    }
+
+    union {
+        VEC_TYPE vector;
+        STREAM_TYPE values[UNROLL_COUNT];
+    } total;
+    total.vector = 0;
+    #pragma unroll
+    for (uint j=0; j<SUM_LATENCY; j++){
+        total.vector += partial[j];
+    }
+    STREAM_TYPE value = 0;
+    #pragma unroll
+    for (uint u=0; u<UNROLL_COUNT; u++){
+        value += total.values[u];
+    }
+    result[0] = value;
+}
+
+__kernel
+void read_ratio(__global const VEC_TYPE * restrict in,
+          __global VEC_TYPE * restrict out,
+          uint array_size) {
+
+    uint count = array_size / (READ_WRITE_RATIO * UNROLL_COUNT);
+    for (uint i=0; i<count; i++){
+        VEC_TYPE value = 0;
+        #pragma unroll
+        for (uint r=0; r<READ_WRITE_RATIO; r++){
+            value += in[r * count + i];
+        }
+        out[i] = value;
+    }
+}
+
+__kernel
+void write_ratio(__global const VEC_TYPE * restrict in,
+          __global VEC_TYPE * restrict out,
+          uint array_size) {
+
+    uint count = array_size / (READ_WRITE_RATIO * UNROLL_COUNT);
+    for (uint i=0; i<count; i++){
+        VEC_TYPE value = in[i];
+        #pragma unroll
+        for (uint r=0; r<READ_WRITE_RATIO; r++){
+            out[r * count + i] = value;
+        }
+    }
+}
+
+/*
+Kernel without any work to measure the launch overhead.
+*/
+__kernel
+void empty() {
+}